@@ -0,0 +1,137 @@
+/// @file alertdaemon.cpp
+/// @brief Implementación de AlertDaemon.
+
+#include "alertdaemon.h"
+#include <QDateTime>
+#include <QSet>
+
+/**
+ * @brief Constructor de AlertDaemon.
+ * @param manager Inventario a vigilar.
+ * @param output Destino de los eventos.
+ * @param intervalMs Milisegundos entre comprobaciones.
+ * @param parent Objeto padre.
+ */
+AlertDaemon::AlertDaemon(InventoryManager* manager, QIODevice* output, int intervalMs, QObject* parent)
+    : QObject(parent), m_manager(manager), m_out(output)
+{
+    m_timer.setInterval(intervalMs);
+    connect(&m_timer, &QTimer::timeout, this, &AlertDaemon::poll);
+}
+
+/**
+ * @brief Publica el estado inicial y empieza a comprobar cambios.
+ */
+void AlertDaemon::start()
+{
+    publish();
+    m_timer.start();
+}
+
+/**
+ * @brief Tick del temporizador.
+ *
+ * No se usa lo que devuelven reloadIfChanged() y refreshAgeing(): si el temporizador de
+ * medianoche del InventoryManager ya avanzó el día, refreshAgeing() devuelve false aunque
+ * haya alertas nuevas. La decisión se toma con la revisión de las alertas.
+ */
+void AlertDaemon::poll()
+{
+    m_manager->reloadIfChanged();
+    m_manager->refreshAgeing();
+    if (m_manager->alertRevision() != m_publishedRevision)
+        publish();
+}
+
+/**
+ * @brief Diferencia entre las alertas activas y las publicadas.
+ *
+ * Cuesta O(alertas activas) y solo se ejecuta cuando algo cambió. Los nombres se guardan al
+ * publicar la alerta para poder escribir la resolución aunque el componente ya no exista.
+ *
+ * La revisión se guarda antes de leer las alertas: un cambio durante la lectura deja una
+ * revisión distinta y se vuelve a publicar en el siguiente tick.
+ */
+void AlertDaemon::publish()
+{
+    m_publishedRevision = m_manager->alertRevision();
+
+    const QList<AlertEngine::Alert> stockAlerts = m_manager->activeAlerts();
+    const QList<AlertEngine::AgeingAlert> ageingAlerts = m_manager->ageingAlerts();
+
+    // Los nombres de las alertas nuevas se leen de una sola vez.
+    QList<int> newIds;
+    for (const AlertEngine::Alert& alert : stockAlerts) {
+        if (!m_stock.contains(alert.id))
+            newIds.append(alert.id);
+    }
+    for (const AlertEngine::AgeingAlert& alert : ageingAlerts) {
+        if (!m_ageing.contains(alert.id))
+            newIds.append(alert.id);
+    }
+    QHash<int, QString> names;
+    if (!newIds.isEmpty()) {
+        for (const Component& comp : m_manager->getComponentsByIds(newIds))
+            names.insert(comp.getId(), comp.getNombre());
+    }
+
+    QSet<int> active;
+    for (const AlertEngine::Alert& alert : stockAlerts) {
+        active.insert(alert.id);
+        if (m_stock.contains(alert.id))
+            continue;
+        const QString nombre = names.value(alert.id);
+        m_stock.insert(alert.id, nombre);
+        writeEvent("nueva", "stock", alert.id, nombre,
+                   QString("cantidad=%1 punto=%2").arg(alert.cantidad).arg(alert.puntoReorden));
+    }
+    for (auto it = m_stock.begin(); it != m_stock.end();) {
+        if (active.contains(it.key())) {
+            ++it;
+            continue;
+        }
+        writeEvent("resuelta", "stock", it.key(), it.value());
+        it = m_stock.erase(it);
+    }
+
+    active.clear();
+    for (const AlertEngine::AgeingAlert& alert : ageingAlerts) {
+        active.insert(alert.id);
+        if (m_ageing.contains(alert.id))
+            continue;
+        const QString nombre = names.value(alert.id);
+        m_ageing.insert(alert.id, nombre);
+        writeEvent("nueva", "antigüedad", alert.id, nombre,
+                   QString("adquirido=%1 caducó=%2")
+                       .arg(alert.fechaAdquisicion.toString("yyyy-MM-dd"))
+                       .arg(alert.caducidad.toString("yyyy-MM-dd")));
+    }
+    for (auto it = m_ageing.begin(); it != m_ageing.end();) {
+        if (active.contains(it.key())) {
+            ++it;
+            continue;
+        }
+        writeEvent("resuelta", "antigüedad", it.key(), it.value());
+        it = m_ageing.erase(it);
+    }
+
+    m_out.flush();
+}
+
+/**
+ * @brief Escribe una línea de evento separada por tabuladores.
+ * @param estado Estado de la alerta.
+ * @param clase Clase de alerta.
+ * @param id ID del componente.
+ * @param nombre Nombre del componente.
+ * @param detalle Datos adicionales.
+ */
+void AlertDaemon::writeEvent(const QString& estado, const QString& clase, int id,
+                             const QString& nombre, const QString& detalle)
+{
+    m_out << QDateTime::currentDateTime().toString(Qt::ISODate) << '\t' << estado << '\t'
+          << clase << '\t' << id << '\t' << nombre;
+    if (!detalle.isEmpty())
+        m_out << '\t' << detalle;
+    m_out << '\n';
+}
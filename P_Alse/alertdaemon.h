@@ -0,0 +1,85 @@
+#ifndef ALERTDAEMON_H
+#define ALERTDAEMON_H
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QTextStream>
+#include <QTimer>
+#include "inventorymanager.h"
+
+class QIODevice;
+
+/// @file alertdaemon.h
+/// @brief Declaración de la clase AlertDaemon, evaluador de alertas sin interfaz gráfica.
+
+/**
+ * @class AlertDaemon
+ * @brief Comprueba periódicamente las alertas del inventario y escribe las que aparecen y
+ * las que se resuelven.
+ *
+ * En cada tick del temporizador se lee PRAGMA data_version (InventoryManager::reloadIfChanged())
+ * y se comprueba si cambió el día (InventoryManager::refreshAgeing()). Después se compara
+ * InventoryManager::alertRevision() con la de la última publicación: así se publican también
+ * los cambios que hizo otro temporizador (el de medianoche del propio InventoryManager), que
+ * dejan a refreshAgeing() sin nada que hacer. Si la revisión no cambió, el tick cuesta una
+ * consulta PRAGMA y no reserva memoria. Si cambió, se comparan las alertas activas con las
+ * ya publicadas y se escribe una línea por cada alerta nueva o resuelta:
+ * @code
+ * 2026-10-18T08:00:00	nueva	stock	42	Resistor 10k	cantidad=2 punto=5
+ * 2026-10-18T08:00:00	nueva	antigüedad	17	Capacitor 100uF	adquirido=2024-01-10 caducó=2026-01-10
+ * 2026-10-18T09:30:00	resuelta	stock	42	Resistor 10k
+ * @endcode
+ * Los campos van separados por tabuladores. Al arrancar se publican todas las alertas
+ * activas como nuevas.
+ */
+class AlertDaemon : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructor del evaluador.
+     * @param manager Inventario a vigilar (no se toma posesión).
+     * @param output Destino ya abierto de los eventos (archivo o salida estándar).
+     * @param intervalMs Milisegundos entre comprobaciones.
+     * @param parent Objeto padre (por defecto nullptr).
+     */
+    AlertDaemon(InventoryManager* manager, QIODevice* output, int intervalMs, QObject* parent = nullptr);
+
+    /**
+     * @brief Publica las alertas activas y arranca el temporizador.
+     */
+    void start();
+
+private slots:
+    /**
+     * @brief Comprueba si hubo cambios y, si los hubo, publica las diferencias.
+     */
+    void poll();
+
+private:
+    /**
+     * @brief Compara las alertas activas con las publicadas y escribe las diferencias.
+     */
+    void publish();
+
+    /**
+     * @brief Escribe un evento.
+     * @param estado "nueva" o "resuelta".
+     * @param clase "stock" o "antigüedad".
+     * @param id ID del componente.
+     * @param nombre Nombre del componente.
+     * @param detalle Datos de la alerta (vacío en las resueltas).
+     */
+    void writeEvent(const QString& estado, const QString& clase, int id,
+                    const QString& nombre, const QString& detalle = QString());
+
+    InventoryManager* m_manager;      ///< Inventario vigilado.
+    QTextStream m_out;                ///< Flujo de eventos.
+    QTimer m_timer;                   ///< Temporizador de comprobación.
+    QHash<int, QString> m_stock;      ///< Alertas de stock publicadas: ID -> nombre.
+    QHash<int, QString> m_ageing;     ///< Alertas de antigüedad publicadas: ID -> nombre.
+    quint64 m_publishedRevision = 0;  ///< alertRevision() al empezar la última publicación.
+};
+
+#endif // ALERTDAEMON_H
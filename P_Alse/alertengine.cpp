@@ -0,0 +1,343 @@
+/// @file alertengine.cpp
+/// @brief Implementación de AlertEngine.
+
+#include "alertengine.h"
+#include "searchkey.h"
+#include <algorithm>
+
+/**
+ * @brief Olvida alertas, puntos de reorden y reglas.
+ */
+void AlertEngine::clear()
+{
+    m_componentPoints.clear();
+    m_tipoPoints.clear();
+    m_active.clear();
+    m_bySeverity.clear();
+    m_rules.clear();
+    m_aged.clear();
+    m_byCaducidad.clear();
+    updateCutoffs();
+    ++m_revision;
+}
+
+/**
+ * @brief Reemplaza los puntos de reorden por los leídos de la base de datos.
+ * @param components Puntos por ID de componente.
+ * @param tipos Puntos por clave de tipo.
+ */
+void AlertEngine::setReorderPoints(const QHash<int, int>& components, const QHash<QString, int>& tipos)
+{
+    m_componentPoints = components;
+    m_tipoPoints = tipos;
+}
+
+/**
+ * @brief Guarda o quita el punto propio de un componente.
+ * @param id ID del componente.
+ * @param point Punto, o std::nullopt para quitarlo.
+ */
+void AlertEngine::setComponentReorderPoint(int id, std::optional<int> point)
+{
+    if (point)
+        m_componentPoints.insert(id, *point);
+    else
+        m_componentPoints.remove(id);
+}
+
+/**
+ * @brief Guarda o quita el punto de un tipo.
+ * @param tipo Tipo.
+ * @param point Punto, o std::nullopt para quitarlo.
+ */
+void AlertEngine::setTipoReorderPoint(const QString& tipo, std::optional<int> point)
+{
+    const QString key = SearchKey::normalize(tipo);
+    if (point)
+        m_tipoPoints.insert(key, *point);
+    else
+        m_tipoPoints.remove(key);
+}
+
+/**
+ * @brief Punto propio de un componente.
+ * @param id ID del componente.
+ * @return Punto, o std::nullopt.
+ */
+std::optional<int> AlertEngine::componentReorderPoint(int id) const
+{
+    auto it = m_componentPoints.constFind(id);
+    if (it == m_componentPoints.constEnd())
+        return std::nullopt;
+    return it.value();
+}
+
+/**
+ * @brief Punto de un tipo.
+ * @param tipo Tipo.
+ * @return Punto, o std::nullopt.
+ */
+std::optional<int> AlertEngine::tipoReorderPoint(const QString& tipo) const
+{
+    auto it = m_tipoPoints.constFind(SearchKey::normalize(tipo));
+    if (it == m_tipoPoints.constEnd())
+        return std::nullopt;
+    return it.value();
+}
+
+/**
+ * @brief Resuelve el punto de reorden de un componente (propio, de su tipo o por defecto).
+ * @param comp Componente.
+ * @return Punto aplicado.
+ */
+int AlertEngine::reorderPoint(const Component& comp) const
+{
+    if (const std::optional<int> own = componentReorderPoint(comp.getId()))
+        return *own;
+    if (const std::optional<int> byTipo = tipoReorderPoint(comp.getTipo()))
+        return *byTipo;
+    return DefaultReorderPoint;
+}
+
+/**
+ * @brief Reemplaza las reglas de caducidad y recalcula sus cortes.
+ * @param rules Reglas.
+ */
+void AlertEngine::setAgeingRules(const QList<AgeingRule>& rules)
+{
+    m_rules = rules;
+    updateCutoffs();
+}
+
+/**
+ * @brief Cambia la fecha de referencia y recalcula los cortes de las reglas.
+ * @param today Nueva fecha.
+ */
+void AlertEngine::setToday(const QDate& today)
+{
+    m_today = today;
+    updateCutoffs();
+}
+
+/**
+ * @brief Busca la última fecha d con d + meses anterior a @p today.
+ *
+ * QDate::addMonths() ajusta al último día del mes (31 de enero + 1 mes = 28 de febrero), así
+ * que restar meses a @p today no basta: se parte de ahí y se corrige día a día. La
+ * corrección es de unos pocos días como mucho, porque addMonths() es monótona.
+ *
+ * @param rule Regla.
+ * @param today Fecha de referencia.
+ * @return Última fecha caducada.
+ */
+QDate AlertEngine::ageingCutoff(const AgeingRule& rule, const QDate& today)
+{
+    QDate cutoff = today.addMonths(-rule.meses);
+    while (cutoff.addMonths(rule.meses) >= today)
+        cutoff = cutoff.addDays(-1);
+    while (cutoff.addDays(1).addMonths(rule.meses) < today)
+        cutoff = cutoff.addDays(1);
+    return cutoff;
+}
+
+/**
+ * @brief Precalcula la clave de tipo y el corte de cada regla.
+ */
+void AlertEngine::updateCutoffs()
+{
+    m_ruleKeys.clear();
+    m_cutoffs.clear();
+    for (const AgeingRule& rule : m_rules) {
+        m_ruleKeys.append(rule.tipo.isEmpty() ? QString() : SearchKey::normalize(rule.tipo));
+        m_cutoffs.append(ageingCutoff(rule, m_today));
+    }
+}
+
+/**
+ * @brief Evalúa las dos clases de alerta de un componente.
+ * @param comp Componente.
+ * @return true si alguna cambió.
+ */
+bool AlertEngine::evaluate(const Component& comp)
+{
+    const bool stock = evaluateStock(comp);
+    const bool ageing = evaluateAgeing(comp);
+    if (!stock && !ageing)
+        return false;
+    ++m_revision;
+    return true;
+}
+
+/**
+ * @brief Activa, actualiza o quita la alerta de bajo stock de un componente.
+ *
+ * Solo toca la entrada del componente en m_active y su clave en m_bySeverity.
+ *
+ * @param comp Componente.
+ * @return true si el conjunto de alertas cambió.
+ */
+bool AlertEngine::evaluateStock(const Component& comp)
+{
+    const int point = reorderPoint(comp);
+    if (comp.getCantidad() > point)
+        return removeStock(comp.getId());
+
+    const Alert alert{comp.getId(), comp.getCantidad(), point};
+    auto it = m_active.find(alert.id);
+    if (it != m_active.end()) {
+        if (it.value().cantidad == alert.cantidad && it.value().puntoReorden == alert.puntoReorden)
+            return false;
+        m_bySeverity.erase(severityKey(*it));
+        *it = alert;
+    } else {
+        m_active.insert(alert.id, alert);
+    }
+    m_bySeverity.insert(severityKey(alert));
+    return true;
+}
+
+/**
+ * @brief Activa, actualiza o quita la alerta de antigüedad de un componente.
+ *
+ * De las reglas que lo declaran caducado se queda con la de caducidad más temprana. Con
+ * pocas reglas el coste es constante; la clave del tipo se calcula una sola vez.
+ *
+ * @param comp Componente.
+ * @return true si cambió.
+ */
+bool AlertEngine::evaluateAgeing(const Component& comp)
+{
+    const QDate fecha = comp.getFechaAdquisicion();
+    if (!fecha.isValid() || m_rules.isEmpty())
+        return removeAgeing(comp.getId());
+
+    const QString tipoKey = SearchKey::normalize(comp.getTipo());
+    AgeingAlert alert;
+    for (int i = 0; i < m_rules.size(); ++i) {
+        if (fecha > m_cutoffs.at(i))
+            continue;
+        if (!m_ruleKeys.at(i).isEmpty() && m_ruleKeys.at(i) != tipoKey)
+            continue;
+        const QDate caducidad = fecha.addMonths(m_rules.at(i).meses);
+        if (alert.id < 0 || caducidad < alert.caducidad)
+            alert = AgeingAlert{comp.getId(), m_rules.at(i).id, fecha, caducidad};
+    }
+    if (alert.id < 0)
+        return removeAgeing(comp.getId());
+
+    auto it = m_aged.find(alert.id);
+    if (it != m_aged.end()) {
+        if (it.value().ruleId == alert.ruleId && it.value().caducidad == alert.caducidad)
+            return false;
+        m_byCaducidad.erase({it.value().caducidad.toJulianDay(), alert.id});
+        *it = alert;
+    } else {
+        m_aged.insert(alert.id, alert);
+    }
+    m_byCaducidad.insert({alert.caducidad.toJulianDay(), alert.id});
+    return true;
+}
+
+/**
+ * @brief Quita las alertas de un componente, si las tiene, y olvida su punto propio.
+ * @param id ID del componente.
+ * @return true si se quitó alguna alerta.
+ */
+bool AlertEngine::remove(int id)
+{
+    m_componentPoints.remove(id);
+    const bool stock = removeStock(id);
+    const bool ageing = removeAgeing(id);
+    if (!stock && !ageing)
+        return false;
+    ++m_revision;
+    return true;
+}
+
+/**
+ * @brief Quita la alerta de bajo stock de un componente.
+ * @param id ID del componente.
+ * @return true si tenía una.
+ */
+bool AlertEngine::removeStock(int id)
+{
+    auto it = m_active.find(id);
+    if (it == m_active.end())
+        return false;
+    m_bySeverity.erase(severityKey(*it));
+    m_active.erase(it);
+    return true;
+}
+
+/**
+ * @brief Quita la alerta de antigüedad de un componente.
+ * @param id ID del componente.
+ * @return true si tenía una.
+ */
+bool AlertEngine::removeAgeing(int id)
+{
+    auto it = m_aged.find(id);
+    if (it == m_aged.end())
+        return false;
+    m_byCaducidad.erase({it.value().caducidad.toJulianDay(), id});
+    m_aged.erase(it);
+    return true;
+}
+
+/**
+ * @brief Busca la alerta activa de un componente.
+ * @param id ID del componente.
+ * @return Alerta, o std::nullopt.
+ */
+std::optional<AlertEngine::Alert> AlertEngine::alert(int id) const
+{
+    auto it = m_active.constFind(id);
+    if (it == m_active.constEnd())
+        return std::nullopt;
+    return it.value();
+}
+
+/**
+ * @brief Recorre el índice de gravedad desde el principio.
+ * @param limit Número máximo de alertas (-1 sin límite).
+ * @return Alertas ordenadas.
+ */
+QList<AlertEngine::Alert> AlertEngine::alerts(int limit) const
+{
+    QList<Alert> list;
+    const int count = limit < 0 ? size() : std::min(limit, size());
+    list.reserve(count);
+    for (auto it = m_bySeverity.cbegin(); it != m_bySeverity.cend() && list.size() < count; ++it)
+        list.append(m_active.value(it->second));
+    return list;
+}
+
+/**
+ * @brief Recorre el índice de caducidades desde la más antigua.
+ * @param limit Número máximo de alertas (-1 sin límite).
+ * @return Alertas ordenadas.
+ */
+QList<AlertEngine::AgeingAlert> AlertEngine::ageingAlerts(int limit) const
+{
+    QList<AgeingAlert> list;
+    const int count = limit < 0 ? int(m_aged.size()) : std::min(limit, int(m_aged.size()));
+    list.reserve(count);
+    for (auto it = m_byCaducidad.cbegin(); it != m_byCaducidad.cend() && list.size() < count; ++it)
+        list.append(m_aged.value(it->second));
+    return list;
+}
+
+/**
+ * @brief Busca las alertas de antigüedad de una regla.
+ * @param ruleId ID de la regla.
+ * @return IDs de componentes.
+ */
+QList<int> AlertEngine::agedByRule(int ruleId) const
+{
+    QList<int> ids;
+    for (auto it = m_aged.constBegin(); it != m_aged.constEnd(); ++it) {
+        if (it.value().ruleId == ruleId)
+            ids.append(it.key());
+    }
+    return ids;
+}
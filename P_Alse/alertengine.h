@@ -0,0 +1,296 @@
+#ifndef ALERTENGINE_H
+#define ALERTENGINE_H
+
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+#include <optional>
+#include <set>
+#include <utility>
+#include "component.h"
+
+/// @file alertengine.h
+/// @brief Declaración de la clase AlertEngine, conjunto incremental de alertas de stock y antigüedad.
+
+/**
+ * @class AlertEngine
+ * @brief Mantiene las alertas de bajo stock y de antigüedad activas.
+ *
+ * Un componente está en alerta cuando su cantidad es menor o igual que su punto de
+ * reorden. Ese punto se toma, por este orden, del propio componente, de su tipo (sin
+ * distinguir mayúsculas ni acentos, ver SearchKey) o de DefaultReorderPoint.
+ *
+ * El motor no recorre el inventario: quien modifica un componente llama a evaluate() o a
+ * remove() solo para ese componente, y el conjunto de alertas activas, ordenado por
+ * gravedad, se actualiza en O(log n). Así el coste de mantener las alertas es proporcional
+ * a las filas cambiadas y no al tamaño del inventario.
+ *
+ * Las alertas de antigüedad las definen reglas de caducidad ("tipo=capacitor, más de 24
+ * meses"): un componente está en alerta si alguna regla de su tipo (o una regla sin tipo)
+ * lo declara caducado en la fecha de referencia today(). Como la caducidad solo depende de
+ * la fecha de adquisición, el conjunto de componentes caducados por una regla es siempre un
+ * prefijo de las fechas, hasta ageingCutoff(); al cambiar de día solo hay que evaluar las
+ * fechas entre el corte anterior y el nuevo.
+ */
+class AlertEngine {
+public:
+    /// Punto de reorden de los componentes sin punto propio ni de su tipo.
+    static constexpr int DefaultReorderPoint = 5;
+
+    /**
+     * @struct Alert
+     * @brief Alerta activa de un componente.
+     */
+    struct Alert {
+        int id = -1;           ///< ID del componente.
+        int cantidad = 0;      ///< Cantidad al evaluarlo.
+        int puntoReorden = 0;  ///< Punto de reorden aplicado.
+
+        /**
+         * @brief Gravedad de la alerta: unidades por debajo del punto de reorden.
+         * @return 0 si la cantidad es justo el punto de reorden; mayor cuanto más falte.
+         */
+        qint64 severity() const { return qint64(puntoReorden) - cantidad; }
+    };
+
+    /**
+     * @struct AgeingRule
+     * @brief Regla de caducidad: los componentes de un tipo caducan a los @c meses de su
+     * adquisición.
+     */
+    struct AgeingRule {
+        int id = -1;   ///< ID de la regla en la base de datos.
+        QString tipo;  ///< Tipo al que se aplica; vacío para todos los tipos.
+        int meses = 0; ///< Antigüedad máxima en meses.
+    };
+
+    /**
+     * @struct AgeingAlert
+     * @brief Alerta de antigüedad de un componente.
+     */
+    struct AgeingAlert {
+        int id = -1;               ///< ID del componente.
+        int ruleId = -1;           ///< Regla que lo declaró caducado (la de caducidad más temprana).
+        QDate fechaAdquisicion;    ///< Fecha de adquisición al evaluarlo.
+        QDate caducidad;           ///< Último día en que aún no estaba caducado.
+
+        /**
+         * @brief Días transcurridos desde la caducidad.
+         * @param today Fecha de referencia.
+         * @return Días de retraso (al menos 1 si la alerta está activa).
+         */
+        qint64 daysOver(const QDate& today) const { return caducidad.daysTo(today); }
+    };
+
+    /**
+     * @brief Vacía las alertas, los puntos de reorden y las reglas de caducidad.
+     */
+    void clear();
+
+    /**
+     * @brief Sustituye todos los puntos de reorden (por ejemplo, al leerlos de la base de datos).
+     *
+     * No vuelve a evaluar las alertas activas: quien llama debe evaluar después los
+     * componentes afectados.
+     *
+     * @param components Punto propio de cada componente que lo tiene, por ID.
+     * @param tipos Punto de cada tipo que lo tiene, por clave de tipo (SearchKey).
+     */
+    void setReorderPoints(const QHash<int, int>& components, const QHash<QString, int>& tipos);
+
+    /**
+     * @brief Cambia el punto de reorden propio de un componente.
+     * @param id ID del componente.
+     * @param point Nuevo punto, o std::nullopt para heredar el de su tipo.
+     */
+    void setComponentReorderPoint(int id, std::optional<int> point);
+
+    /**
+     * @brief Cambia el punto de reorden de un tipo.
+     * @param tipo Tipo (se normaliza con SearchKey).
+     * @param point Nuevo punto, o std::nullopt para usar DefaultReorderPoint.
+     */
+    void setTipoReorderPoint(const QString& tipo, std::optional<int> point);
+
+    /**
+     * @brief Punto de reorden propio de un componente.
+     * @param id ID del componente.
+     * @return Punto, o std::nullopt si hereda el de su tipo.
+     */
+    std::optional<int> componentReorderPoint(int id) const;
+
+    /**
+     * @brief Punto de reorden de un tipo.
+     * @param tipo Tipo.
+     * @return Punto, o std::nullopt si el tipo usa DefaultReorderPoint.
+     */
+    std::optional<int> tipoReorderPoint(const QString& tipo) const;
+
+    /**
+     * @brief Punto de reorden que se aplica a un componente.
+     * @param comp Componente.
+     * @return Punto propio, el de su tipo o DefaultReorderPoint.
+     */
+    int reorderPoint(const Component& comp) const;
+
+    /**
+     * @brief Sustituye las reglas de caducidad.
+     *
+     * Como setReorderPoints(), no vuelve a evaluar las alertas activas.
+     *
+     * @param rules Reglas.
+     */
+    void setAgeingRules(const QList<AgeingRule>& rules);
+
+    /**
+     * @brief Reglas de caducidad vigentes.
+     * @return Reglas en el orden en que se dieron.
+     */
+    const QList<AgeingRule>& ageingRules() const { return m_rules; }
+
+    /**
+     * @brief Cambia la fecha de referencia de las reglas de caducidad.
+     *
+     * No vuelve a evaluar las alertas: quien llama debe evaluar los componentes cuya fecha
+     * de adquisición quedó entre el corte anterior y el nuevo de cada regla.
+     *
+     * @param today Nueva fecha de referencia.
+     */
+    void setToday(const QDate& today);
+
+    /**
+     * @brief Fecha de referencia de las reglas de caducidad.
+     * @return Fecha (inicialmente, la fecha actual).
+     */
+    QDate today() const { return m_today; }
+
+    /**
+     * @brief Última fecha de adquisición que una regla considera caducada.
+     * @param rule Regla.
+     * @param today Fecha de referencia.
+     * @return Fecha d tal que los componentes adquiridos en d o antes tienen más de
+     *         @c rule.meses meses en @p today.
+     */
+    static QDate ageingCutoff(const AgeingRule& rule, const QDate& today);
+
+    /**
+     * @brief Vuelve a evaluar un componente nuevo o modificado (stock y antigüedad).
+     * @param comp Componente con sus datos actuales.
+     * @return true si el conjunto de alertas activas cambió.
+     */
+    bool evaluate(const Component& comp);
+
+    /**
+     * @brief Quita las alertas y el punto de reorden propio de un componente eliminado.
+     * @param id ID del componente.
+     * @return true si tenía alguna alerta activa.
+     */
+    bool remove(int id);
+
+    /**
+     * @brief Alerta de bajo stock activa de un componente.
+     * @param id ID del componente.
+     * @return La alerta, o std::nullopt si no está en alerta.
+     */
+    std::optional<Alert> alert(int id) const;
+
+    /**
+     * @brief Alertas de bajo stock activas de la más a la menos grave.
+     * @param limit Número máximo de alertas, o -1 para todas.
+     * @return Alertas por gravedad decreciente (a igual gravedad, por ID).
+     */
+    QList<Alert> alerts(int limit = -1) const;
+
+    /**
+     * @brief Número de alertas de bajo stock activas.
+     * @return Alertas activas.
+     */
+    int size() const { return int(m_active.size()); }
+
+    /**
+     * @brief Alertas de antigüedad de la más a la menos antigua.
+     * @param limit Número máximo de alertas, o -1 para todas.
+     * @return Alertas por caducidad creciente (a igual caducidad, por ID).
+     */
+    QList<AgeingAlert> ageingAlerts(int limit = -1) const;
+
+    /**
+     * @brief IDs de los componentes con alerta de antigüedad debida a una regla.
+     * @param ruleId ID de la regla.
+     * @return IDs afectados.
+     */
+    QList<int> agedByRule(int ruleId) const;
+
+    /**
+     * @brief Contador de cambios de las alertas.
+     *
+     * Aumenta cada vez que evaluate(), remove() o clear() cambian alguna alerta, sea quien
+     * sea quien los llame; quien guarde el valor puede saber después si hubo cambios sin
+     * comparar las listas.
+     *
+     * @return Revisión actual.
+     */
+    quint64 revision() const { return m_revision; }
+
+private:
+    /**
+     * @brief Vuelve a evaluar la alerta de bajo stock de un componente.
+     * @param comp Componente.
+     * @return true si cambió.
+     */
+    bool evaluateStock(const Component& comp);
+
+    /**
+     * @brief Vuelve a evaluar la alerta de antigüedad de un componente.
+     * @param comp Componente.
+     * @return true si cambió.
+     */
+    bool evaluateAgeing(const Component& comp);
+
+    /**
+     * @brief Quita la alerta de bajo stock de un componente.
+     * @param id ID del componente.
+     * @return true si tenía una.
+     */
+    bool removeStock(int id);
+
+    /**
+     * @brief Quita la alerta de antigüedad de un componente.
+     * @param id ID del componente.
+     * @return true si tenía una.
+     */
+    bool removeAgeing(int id);
+
+    /**
+     * @brief Recalcula m_cutoffs y m_ruleKeys para las reglas y la fecha actuales.
+     */
+    void updateCutoffs();
+
+    /// Clave de orden: (-gravedad, ID), para recorrer de la más a la menos grave.
+    using SeverityKey = std::pair<qint64, int>;
+
+    /**
+     * @brief Clave de orden de una alerta.
+     * @param alert Alerta.
+     * @return Clave en m_bySeverity.
+     */
+    static SeverityKey severityKey(const Alert& alert) { return {-alert.severity(), alert.id}; }
+
+    QHash<int, int> m_componentPoints; ///< ID -> punto de reorden propio.
+    QHash<QString, int> m_tipoPoints;  ///< Clave de tipo -> punto de reorden.
+    QHash<int, Alert> m_active;        ///< Alertas activas por ID.
+    std::set<SeverityKey> m_bySeverity; ///< Alertas activas en orden de gravedad.
+
+    QDate m_today = QDate::currentDate(); ///< Fecha de referencia de las reglas de caducidad.
+    QList<AgeingRule> m_rules;          ///< Reglas de caducidad.
+    QVector<QString> m_ruleKeys;        ///< Clave de tipo de cada regla (vacía = todos).
+    QVector<QDate> m_cutoffs;           ///< ageingCutoff() de cada regla en m_today.
+    QHash<int, AgeingAlert> m_aged;     ///< Alertas de antigüedad por ID.
+    std::set<std::pair<qint64, int>> m_byCaducidad; ///< (día juliano de caducidad, ID) en orden.
+
+    quint64 m_revision = 0;             ///< Ver revision().
+};
+
+#endif // ALERTENGINE_H
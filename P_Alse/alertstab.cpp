@@ -2,13 +2,18 @@
 /// @brief Implementación de la clase AlertsTab que muestra componentes con cantidades bajas.
 
 #include "alertstab.h"
+#include "fieldcompleter.h"
+#include <QHash>
+#include <QHBoxLayout>
+#include <QLabel>
 #include <QVBoxLayout>
 #include <QTableWidgetItem>
 
 /**
  * @brief Constructor de AlertsTab.
  *
- * Crea una tabla y la inicializa con los componentes cuya cantidad está por debajo del umbral.
+ * Crea una tabla y la inicializa con las alertas activas, junto con el editor de puntos de
+ * reorden.
  *
  * @param manager Puntero al InventoryManager que maneja los componentes.
  * @param parent Widget padre, por defecto nullptr.
@@ -19,48 +24,243 @@ AlertsTab::AlertsTab(InventoryManager* manager, QWidget* parent)
     // Layout vertical principal
     QVBoxLayout* mainLayout = new QVBoxLayout(this);
 
-    // Crear tabla de alertas
+    // Selector de vista
+    viewCombo = new QComboBox(this);
+    viewCombo->addItems(QStringList()
+                        << "Alertas activas"
+                        << "Antigüedad"
+                        << QString("Más críticos (%1)").arg(criticalCount)
+                        << QString("Últimas adquisiciones (%1)").arg(recentCount));
+    mainLayout->addWidget(viewCombo);
+
+    // Crear tabla de alertas (las columnas dependen de la vista, ver refreshAlerts())
     alertTable = new QTableWidget(this);
-    alertTable->setColumnCount(5);
-    alertTable->setHorizontalHeaderLabels(QStringList()
-                                          << "Nombre"
-                                          << "Tipo"
-                                          << "Cantidad"
-                                          << "Ubicación"
-                                          << "Fecha");
+    alertTable->setSelectionBehavior(QAbstractItemView::SelectRows);
 
     mainLayout->addWidget(alertTable);
 
+    // Editor del punto de reorden del componente seleccionado
+    QHBoxLayout* pointLayout = new QHBoxLayout;
+    pointSpin = new QSpinBox(this);
+    pointSpin->setRange(-1, 1000000);
+    pointSpin->setSpecialValueText("Heredado");
+    pointSpin->setValue(-1);
+    componentPointButton = new QPushButton("Aplicar al componente", this);
+    tipoPointButton = new QPushButton("Aplicar al tipo", this);
+
+    pointLayout->addWidget(new QLabel("Punto de reorden:", this));
+    pointLayout->addWidget(pointSpin);
+    pointLayout->addWidget(componentPointButton);
+    pointLayout->addWidget(tipoPointButton);
+    mainLayout->addLayout(pointLayout);
+
+    // Reglas de caducidad
+    QHBoxLayout* ruleLayout = new QHBoxLayout;
+    ruleCombo = new QComboBox(this);
+    removeRuleButton = new QPushButton("Eliminar regla", this);
+    ruleTipoEdit = new QLineEdit(this);
+    ruleTipoEdit->setPlaceholderText("Tipo (vacío = todos)");
+    new FieldCompleter(m_manager, Component::Field::Tipo, ruleTipoEdit);
+    ruleMonthsSpin = new QSpinBox(this);
+    ruleMonthsSpin->setRange(1, 1200);
+    ruleMonthsSpin->setValue(24);
+    ruleMonthsSpin->setSuffix(" meses");
+    addRuleButton = new QPushButton("Agregar regla", this);
+
+    ruleLayout->addWidget(new QLabel("Caducidad:", this));
+    ruleLayout->addWidget(ruleCombo, 1);
+    ruleLayout->addWidget(removeRuleButton);
+    ruleLayout->addWidget(ruleTipoEdit);
+    ruleLayout->addWidget(ruleMonthsSpin);
+    ruleLayout->addWidget(addRuleButton);
+    mainLayout->addLayout(ruleLayout);
+
+    connect(viewCombo, &QComboBox::currentIndexChanged, this, &AlertsTab::refreshAlerts);
+    connect(alertTable, &QTableWidget::currentCellChanged, this, &AlertsTab::showSelectedPoint);
+    connect(componentPointButton, &QPushButton::clicked, this, &AlertsTab::applyComponentPoint);
+    connect(tipoPointButton, &QPushButton::clicked, this, &AlertsTab::applyTipoPoint);
+    connect(addRuleButton, &QPushButton::clicked, this, &AlertsTab::addAgeingRule);
+    connect(removeRuleButton, &QPushButton::clicked, this, &AlertsTab::removeAgeingRule);
+
     // Mostrar componentes con cantidad baja
+    refreshRules();
     refreshAlerts();
 }
 
 /**
- * @brief Actualiza la tabla con los componentes cuya cantidad es menor o igual al umbral.
+ * @brief Actualiza la tabla con los componentes de la vista seleccionada.
+ *
+ * Las alertas de stock y de antigüedad ya están ordenadas en el AlertEngine y las otras
+ * vistas recorren los índices ordenados de cantidad o fecha, así que solo se leen las filas
+ * que se muestran.
+ *
+ * La vista de antigüedad cambia la columna del punto de reorden por la fecha de caducidad y
+ * los días transcurridos desde ella.
  */
 void AlertsTab::refreshAlerts()
 {
-    // Obtener todos los componentes desde el administrador
-    QList<Component> all = m_manager->getAllComponents();
-    QList<Component> alerts;
-
-    // Filtrar por componentes con cantidad menor o igual al umbral
-    for (const Component& c : all) {
-        if (c.getCantidad() <= threshold) {
-            alerts.append(c);
+    const bool ageing = viewCombo->currentIndex() == 1;
+    QList<Component> shown;
+    QList<int> ids;
+    QHash<int, AlertEngine::AgeingAlert> ageingById;
+    switch (viewCombo->currentIndex()) {
+    case 1:
+        for (const AlertEngine::AgeingAlert& alert : m_manager->ageingAlerts()) {
+            ids.append(alert.id);
+            ageingById.insert(alert.id, alert);
         }
+        shown = componentsInOrder(ids);
+        break;
+    case 2:
+        shown = m_manager->lowestStock(criticalCount);
+        break;
+    case 3:
+        shown = m_manager->mostRecent(recentCount);
+        break;
+    default:
+        for (const AlertEngine::Alert& alert : m_manager->activeAlerts())
+            ids.append(alert.id);
+        shown = componentsInOrder(ids);
+        break;
+    }
+
+    QStringList headers;
+    headers << "Nombre" << "Tipo" << "Cantidad";
+    if (ageing)
+        headers << "Caducidad" << "Días vencido";
+    else
+        headers << "Punto de reorden";
+    headers << "Ubicación" << "Fecha";
+
+    alertTable->setRowCount(0);
+    alertTable->setColumnCount(headers.size());
+    alertTable->setHorizontalHeaderLabels(headers);
+    alertTable->setRowCount(shown.size());
+    rowToIdMap.clear();
+
+    // Agregar a la tabla los componentes de la vista
+    const QDate today = QDate::currentDate();
+    int row = 0;
+    for (const Component& comp : shown) {
+        int column = 0;
+        alertTable->setItem(row, column++, new QTableWidgetItem(comp.getNombre()));
+        alertTable->setItem(row, column++, new QTableWidgetItem(comp.getTipo()));
+        alertTable->setItem(row, column++, new QTableWidgetItem(QString::number(comp.getCantidad())));
+        if (ageing) {
+            const AlertEngine::AgeingAlert alert = ageingById.value(comp.getId());
+            alertTable->setItem(row, column++, new QTableWidgetItem(alert.caducidad.toString("yyyy-MM-dd")));
+            alertTable->setItem(row, column++, new QTableWidgetItem(QString::number(alert.daysOver(today))));
+        } else {
+            alertTable->setItem(row, column++, new QTableWidgetItem(QString::number(m_manager->reorderPoint(comp))));
+        }
+        alertTable->setItem(row, column++, new QTableWidgetItem(comp.getUbicacion()));
+        alertTable->setItem(row, column++, new QTableWidgetItem(comp.getFechaAdquisicion().toString("yyyy-MM-dd")));
+
+        rowToIdMap[row] = comp.getId();
+        ++row;
+    }
+}
+
+/**
+ * @brief Lee los componentes de una sola vez y los devuelve en el orden de las alertas.
+ * @param ids IDs en el orden de la vista.
+ * @return Componentes encontrados, en ese orden.
+ */
+QList<Component> AlertsTab::componentsInOrder(const QList<int>& ids)
+{
+    QHash<int, Component> byId;
+    for (const Component& comp : m_manager->getComponentsByIds(ids))
+        byId.insert(comp.getId(), comp);
+
+    QList<Component> ordered;
+    ordered.reserve(ids.size());
+    for (int id : ids) {
+        auto it = byId.constFind(id);
+        if (it != byId.constEnd())
+            ordered.append(it.value());
     }
+    return ordered;
+}
+
+/**
+ * @brief Carga en el editor el punto propio del componente de la fila seleccionada.
+ * @param row Fila seleccionada.
+ */
+void AlertsTab::showSelectedPoint(int row)
+{
+    if (!rowToIdMap.contains(row)) return;
+
+    pointSpin->setValue(m_manager->componentReorderPoint(rowToIdMap[row]).value_or(-1));
+}
+
+/**
+ * @brief Asigna el punto del editor al componente seleccionado.
+ */
+void AlertsTab::applyComponentPoint()
+{
+    int row = alertTable->currentRow();
+    if (!rowToIdMap.contains(row)) return;
 
-    // Configurar filas de la tabla según la cantidad de alertas
-    alertTable->setRowCount(alerts.size());
-
-    // Llenar tabla con los datos de componentes en alerta
-    for (int i = 0; i < alerts.size(); ++i) {
-        const Component& comp = alerts.at(i);
-        alertTable->setItem(i, 0, new QTableWidgetItem(comp.getNombre()));
-        alertTable->setItem(i, 1, new QTableWidgetItem(comp.getTipo()));
-        alertTable->setItem(i, 2, new QTableWidgetItem(QString::number(comp.getCantidad())));
-        alertTable->setItem(i, 3, new QTableWidgetItem(comp.getUbicacion()));
-        alertTable->setItem(i, 4, new QTableWidgetItem(comp.getFechaAdquisicion().toString("yyyy-MM-dd")));
+    m_manager->setReorderPoint(rowToIdMap[row], editedPoint());
+    refreshAlerts();
+}
+
+/**
+ * @brief Asigna el punto del editor al tipo del componente seleccionado.
+ */
+void AlertsTab::applyTipoPoint()
+{
+    int row = alertTable->currentRow();
+    if (!rowToIdMap.contains(row) || !alertTable->item(row, 1)) return;
+
+    m_manager->setTipoReorderPoint(alertTable->item(row, 1)->text(), editedPoint());
+    refreshAlerts();
+}
+
+/**
+ * @brief Traduce el valor especial "Heredado" (-1) a std::nullopt.
+ * @return Punto editado.
+ */
+std::optional<int> AlertsTab::editedPoint() const
+{
+    if (pointSpin->value() < 0)
+        return std::nullopt;
+    return pointSpin->value();
+}
+
+/**
+ * @brief Lista las reglas de caducidad en el selector.
+ */
+void AlertsTab::refreshRules()
+{
+    ruleCombo->clear();
+    for (const AlertEngine::AgeingRule& rule : m_manager->ageingRules()) {
+        const QString tipo = rule.tipo.isEmpty() ? QString("Todos") : rule.tipo;
+        ruleCombo->addItem(QString("%1: más de %2 meses").arg(tipo).arg(rule.meses), rule.id);
     }
+    removeRuleButton->setEnabled(ruleCombo->count() > 0);
+}
+
+/**
+ * @brief Agrega una regla con los datos del editor y actualiza la vista.
+ */
+void AlertsTab::addAgeingRule()
+{
+    if (!m_manager->addAgeingRule(ruleTipoEdit->text(), ruleMonthsSpin->value())) return;
+
+    ruleTipoEdit->clear();
+    refreshRules();
+    refreshAlerts();
+}
+
+/**
+ * @brief Elimina la regla seleccionada y actualiza la vista.
+ */
+void AlertsTab::removeAgeingRule()
+{
+    if (ruleCombo->currentIndex() < 0) return;
+
+    m_manager->removeAgeingRule(ruleCombo->currentData().toInt());
+    refreshRules();
+    refreshAlerts();
 }
@@ -2,6 +2,11 @@
 #define ALERTSTAB_H
 
 #include <QWidget>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QMap>
+#include <QPushButton>
+#include <QSpinBox>
 #include <QTableWidget>
 #include "inventorymanager.h"
 
@@ -10,10 +15,21 @@
 
 /**
  * @class AlertsTab
- * @brief Widget que muestra una tabla con los componentes cuyo stock está por debajo de un umbral predefinido.
+ * @brief Widget que muestra una tabla con los componentes cuyo stock está en o por debajo de su
+ * punto de reorden.
  *
- * Esta clase se encarga de visualizar alertas de inventario basadas en la cantidad mínima establecida
- * (por defecto 5 unidades). Muestra nombre, tipo, cantidad, ubicación y fecha de adquisición.
+ * Las alertas las mantiene el AlertEngine de InventoryManager, ordenadas de la más a la menos
+ * grave. El punto de reorden de cada componente es el suyo propio, el de su tipo o, si
+ * ninguno está definido, AlertEngine::DefaultReorderPoint (5 unidades); desde esta pestaña se
+ * puede cambiar el del componente seleccionado o el de su tipo. Muestra nombre, tipo,
+ * cantidad, punto de reorden, ubicación y fecha de adquisición.
+ *
+ * Un selector permite cambiar a la vista de alertas de antigüedad (componentes que superan
+ * la antigüedad máxima de una regla de caducidad, del más al menos antiguo, con su fecha de
+ * caducidad y los días transcurridos desde ella) y a las de los componentes más críticos
+ * (los de menos stock) y de las últimas adquisiciones, que se resuelven con consultas top-k
+ * sin ordenar el inventario completo. Las reglas de caducidad se agregan y eliminan desde
+ * la misma pestaña.
  */
 class AlertsTab : public QWidget {
     Q_OBJECT
@@ -27,14 +43,70 @@ public:
     AlertsTab(InventoryManager* manager, QWidget* parent = nullptr);
 
     /**
-     * @brief Refresca la tabla de alertas mostrando únicamente los componentes con cantidad baja.
+     * @brief Refresca la tabla con los componentes de la vista seleccionada.
      */
     void refreshAlerts();
 
+private slots:
+    /**
+     * @brief Muestra en el editor el punto de reorden propio del componente seleccionado.
+     * @param row Fila seleccionada.
+     */
+    void showSelectedPoint(int row);
+
+    /**
+     * @brief Guarda el punto del editor como punto propio del componente seleccionado.
+     */
+    void applyComponentPoint();
+
+    /**
+     * @brief Guarda el punto del editor como punto del tipo del componente seleccionado.
+     */
+    void applyTipoPoint();
+
+    /**
+     * @brief Agrega una regla de caducidad con el tipo y los meses del editor.
+     */
+    void addAgeingRule();
+
+    /**
+     * @brief Elimina la regla de caducidad seleccionada.
+     */
+    void removeAgeingRule();
+
 private:
-    InventoryManager* m_manager; ///< Puntero al administrador de inventario.
-    QTableWidget* alertTable;    ///< Tabla donde se muestran los componentes en alerta.
-    const int threshold = 5;     ///< Umbral de alerta (cantidad mínima para mostrar advertencia).
+    /**
+     * @brief Valor del editor de punto de reorden.
+     * @return Punto, o std::nullopt si está en "Heredado".
+     */
+    std::optional<int> editedPoint() const;
+
+    /**
+     * @brief Componentes de una lista de IDs, en el mismo orden.
+     * @param ids IDs (por ejemplo, de las alertas por gravedad).
+     * @return Componentes que aún existen.
+     */
+    QList<Component> componentsInOrder(const QList<int>& ids);
+
+    /**
+     * @brief Vuelve a llenar el selector de reglas de caducidad.
+     */
+    void refreshRules();
+
+    InventoryManager* m_manager;        ///< Puntero al administrador de inventario.
+    QComboBox* viewCombo;               ///< Selector de vista (alertas activas, más críticos, recientes).
+    QTableWidget* alertTable;           ///< Tabla donde se muestran los componentes en alerta.
+    QSpinBox* pointSpin;                ///< Editor del punto de reorden (-1 = heredado).
+    QPushButton* componentPointButton;  ///< Aplica el punto al componente seleccionado.
+    QPushButton* tipoPointButton;       ///< Aplica el punto al tipo del componente seleccionado.
+    QComboBox* ruleCombo;               ///< Reglas de caducidad (el dato de cada elemento es su ID).
+    QPushButton* removeRuleButton;      ///< Elimina la regla seleccionada.
+    QLineEdit* ruleTipoEdit;            ///< Tipo de la regla nueva (vacío = todos).
+    QSpinBox* ruleMonthsSpin;           ///< Antigüedad máxima de la regla nueva, en meses.
+    QPushButton* addRuleButton;         ///< Agrega la regla nueva.
+    QMap<int, int> rowToIdMap;          ///< Fila de la tabla -> ID del componente.
+    const int criticalCount = 50;       ///< Componentes de la vista de más críticos.
+    const int recentCount = 100;        ///< Componentes de la vista de últimas adquisiciones.
 };
 
 #endif // ALERTSTAB_H
@@ -13,6 +13,18 @@
  */
 class Component {
 public:
+    /**
+     * @brief Campos de un componente, usados para elegir columnas de orden o de búsqueda.
+     */
+    enum class Field {
+        Id,               ///< Identificador único.
+        Nombre,           ///< Nombre del componente.
+        Tipo,             ///< Tipo o categoría.
+        Cantidad,         ///< Cantidad disponible.
+        Ubicacion,        ///< Ubicación física.
+        FechaAdquisicion  ///< Fecha de adquisición.
+    };
+
     /**
      * @brief Constructor con ID (usado para componentes ya almacenados en la base de datos).
      * @param id Identificador único del componente.
@@ -2,29 +2,87 @@
 /// @brief Implementación de la clase DatabaseManager encargada de la gestión de base de datos SQLite.
 
 #include "databasemanager.h"
+#include "searchkey.h"
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QStringList>
+#include <QThread>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QDateTime>
 #include <QDebug>
+#include <algorithm>
+#include <atomic>
+
+/**
+ * @brief Sentencias preparadas de cada conexión, indexadas por su texto SQL.
+ *
+ * Se comparte (QSharedPointer) con los manejadores de fin de hilo para que un hilo de
+ * trabajo pueda liberar sus sentencias antes de cerrar su conexión, aunque el
+ * DatabaseManager ya no exista.
+ *
+ * Cada conexión guarda como mucho Capacity sentencias; al superarlo se descarta la usada
+ * hace más tiempo, para que los textos generados (cláusulas WHERE de selectComponents, por
+ * ejemplo) no se acumulen sin límite.
+ */
+struct DatabaseManager::StatementCache {
+    static constexpr int Capacity = 64; ///< Sentencias por conexión.
+
+    /// Sentencia guardada y el momento de su último uso.
+    struct Entry {
+        QSharedPointer<QSqlQuery> query; ///< Sentencia preparada.
+        quint64 lastUse = 0;             ///< Valor de clock en el último acceso.
+    };
+
+    QMutex mutex; ///< Protege byConnection y clock.
+    QHash<QString, QHash<QString, Entry>> byConnection; ///< Conexión -> SQL -> sentencia.
+    quint64 clock = 0; ///< Contador de accesos, para el orden LRU.
+    std::atomic<quint64> hits{0};   ///< Sentencias reutilizadas sin volver a compilar.
+    std::atomic<quint64> misses{0}; ///< Sentencias que hubo que preparar.
+};
+
+namespace {
+/// Inserción de un componente, compartida por addComponent y addComponents.
+const char* const kInsertComponentSql =
+    "INSERT INTO components (nombre, nombre_clave, tipo_id, cantidad, ubicacion_id, fechaAdquisicion) "
+    "VALUES (:nombre, :clave, :tipo, :cantidad, :ubicacion, :fecha)";
+
+/// Columnas que espera DatabaseManager::readComponent(), leídas de la vista components_view.
+const char* const kComponentColumns = "id, nombre, tipo, cantidad, ubicacion, fechaAdquisicion";
+}
 
 /**
  * @brief Constructor que inicializa la conexión con la base de datos SQLite.
+ *
+ * Registra una conexión con nombre propio (no la conexión por defecto de Qt), que es la
+ * que usa el hilo que crea el objeto. Los demás hilos obtienen conexiones clonadas de esta.
+ *
  * @param path Ruta del archivo de base de datos.
+ * @param settings Parámetros PRAGMA aplicados a cada conexión.
  */
-DatabaseManager::DatabaseManager(const QString& path)
-    : m_db(QSqlDatabase::addDatabase("QSQLITE"))
+DatabaseManager::DatabaseManager(const QString& path, const DatabaseSettings& settings)
+    : m_connectionName(QString("inventory_%1").arg(quintptr(this), 0, 16)),
+    m_settings(settings),
+    m_ownerThread(QThread::currentThread()),
+    m_statements(QSharedPointer<StatementCache>::create())
 {
+    m_db = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
     m_db.setDatabaseName(path);
+    if (m_settings.busyTimeoutMs > 0)
+        m_db.setConnectOptions(QString("QSQLITE_BUSY_TIMEOUT=%1").arg(m_settings.busyTimeoutMs));
 }
 
 /**
- * @brief Destructor. Cierra la base de datos al destruir el objeto.
+ * @brief Destructor. Cierra la base de datos y elimina el registro de la conexión.
  */
 DatabaseManager::~DatabaseManager() {
     closeDatabase();
+    m_db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(m_connectionName);
 }
 
 /**
- * @brief Abre la base de datos y crea la tabla si no existe.
+ * @brief Abre la base de datos y la lleva a la última versión del esquema.
  * @return true si la operación fue exitosa, false en caso contrario.
  */
 bool DatabaseManager::openDatabase() {
@@ -33,6 +91,135 @@ bool DatabaseManager::openDatabase() {
         return false;
     }
 
+    applyPragmas(m_db);
+
+    if (!runMigrations())
+        return false;
+
+    QSqlQuery query(m_db);
+    query.exec("SELECT 1 FROM sqlite_master WHERE type='table' AND name='components_fts'");
+    m_ftsEnabled = query.next();
+    if (!m_ftsEnabled)
+        qWarning() << "Índice de texto completo no disponible, las búsquedas usarán LIKE.";
+    return true;
+}
+
+/**
+ * @brief Lista ordenada de migraciones del esquema.
+ *
+ * Cada migración debe poder aplicarse sobre bases creadas por versiones anteriores del
+ * programa que aún no registraban user_version (por eso usan IF NOT EXISTS o comprueban el
+ * estado antes de modificarlo). Las nuevas migraciones se agregan siempre al final.
+ *
+ * @return Migraciones en orden de versión.
+ */
+const QList<DatabaseManager::Migration>& DatabaseManager::migrations() {
+    static const QList<Migration> list = {
+        {1, "Tabla components", &DatabaseManager::createComponentsTable},
+        {2, "Fechas de adquisición como días julianos", &DatabaseManager::migrateDatesToJulianDay},
+        {3, "Índices sobre nombre, tipo, ubicación, cantidad y fecha", &DatabaseManager::createIndexes},
+        {4, "Índice de texto completo FTS5", &DatabaseManager::createFullTextIndex},
+        {5, "Tipos y ubicaciones en tablas de diccionario", &DatabaseManager::createDictionaryTables},
+        {6, "Claves de búsqueda normalizadas", &DatabaseManager::createSearchKeys},
+        {7, "Puntos de reorden por componente y por tipo", &DatabaseManager::createReorderPoints},
+        {8, "Reglas de caducidad por tipo", &DatabaseManager::createAgeingRules},
+    };
+    return list;
+}
+
+/**
+ * @brief Versión del esquema que deja openDatabase() al terminar.
+ * @return Número de la última migración.
+ */
+int DatabaseManager::schemaVersion() {
+    return migrations().isEmpty() ? 0 : migrations().constLast().version;
+}
+
+/**
+ * @brief Aplica, en orden, las migraciones posteriores a PRAGMA user_version.
+ *
+ * Cada migración se ejecuta en su propia transacción junto con la actualización de
+ * user_version, de modo que una migración fallida no deja el esquema a medias y se
+ * reintenta en el siguiente arranque. La duración de cada paso se registra en la tabla
+ * schema_migrations y en el log.
+ *
+ * @return true si el esquema quedó en la última versión.
+ */
+bool DatabaseManager::runMigrations() {
+    QSqlQuery query(m_db);
+
+    if (!query.exec("CREATE TABLE IF NOT EXISTS schema_migrations ("
+                    "version INTEGER PRIMARY KEY, "
+                    "description TEXT, "
+                    "applied_at TEXT, "
+                    "duration_ms INTEGER)")) {
+        qWarning() << "Error al crear la tabla de migraciones:" << query.lastError().text();
+        return false;
+    }
+
+    query.exec("PRAGMA user_version");
+    int current = query.next() ? query.value(0).toInt() : 0;
+    query.finish();
+
+    if (current > schemaVersion()) {
+        qWarning() << "La base de datos tiene un esquema más reciente (" << current
+                   << ") que el soportado (" << schemaVersion() << ").";
+        return true;
+    }
+
+    for (const Migration& migration : migrations()) {
+        if (migration.version <= current)
+            continue;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        if (!m_db.transaction()) {
+            qWarning() << "No se pudo iniciar la migración" << migration.version << ":"
+                       << m_db.lastError().text();
+            return false;
+        }
+
+        bool ok = (this->*migration.apply)();
+        if (ok && !query.exec(QString("PRAGMA user_version = %1").arg(migration.version))) {
+            qWarning() << "Error al actualizar user_version:" << query.lastError().text();
+            ok = false;
+        }
+        if (ok && !m_db.commit()) {
+            qWarning() << "Error al confirmar la migración" << migration.version << ":"
+                       << m_db.lastError().text();
+            ok = false;
+        }
+        if (!ok) {
+            m_db.rollback();
+            qWarning() << "Migración" << migration.version << "(" << migration.description
+                       << ") fallida; el esquema queda en la versión" << current;
+            return false;
+        }
+
+        const qint64 elapsed = timer.elapsed();
+        current = migration.version;
+        qInfo() << "Migración" << migration.version << "(" << migration.description
+                << ") aplicada en" << elapsed << "ms";
+
+        query.prepare("INSERT OR REPLACE INTO schema_migrations "
+                      "(version, description, applied_at, duration_ms) VALUES (?, ?, ?, ?)");
+        query.addBindValue(migration.version);
+        query.addBindValue(QString::fromUtf8(migration.description));
+        query.addBindValue(QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+        query.addBindValue(elapsed);
+        if (!query.exec())
+            qWarning() << "No se pudo registrar la migración:" << query.lastError().text();
+    }
+
+    return true;
+}
+
+/**
+ * @brief Crea la tabla principal de componentes si no existe.
+ * @return true si la tabla existe al terminar.
+ */
+bool DatabaseManager::createComponentsTable() {
     QSqlQuery query(m_db);
     bool ok = query.exec(
         "CREATE TABLE IF NOT EXISTS components ("
@@ -41,7 +228,7 @@ bool DatabaseManager::openDatabase() {
         "tipo TEXT, "
         "cantidad INTEGER, "
         "ubicacion TEXT, "
-        "fechaAdquisicion TEXT)"
+        "fechaAdquisicion INTEGER)"   // Día juliano (QDate::toJulianDay)
         );
 
     if (!ok)
@@ -51,93 +238,1129 @@ bool DatabaseManager::openDatabase() {
 }
 
 /**
- * @brief Cierra la base de datos si está abierta.
+ * @brief Convierte en el sitio una tabla components antigua con fechas de texto.
+ *
+ * Las bases creadas antes de usar días julianos guardan fechaAdquisicion como TEXT
+ * ("yyyy-MM-dd"). Como SQLite no permite cambiar el tipo de una columna, la tabla se
+ * reconstruye: se copian las filas conservando sus IDs, convirtiendo cada fecha con
+ * julianday() (las vacías o inválidas quedan en NULL), y se restaura el contador
+ * AUTOINCREMENT. Los índices y triggers de la tabla antigua los recrean las migraciones
+ * siguientes; el índice FTS no cambia porque los textos y rowids se conservan. Se ejecuta
+ * dentro de la transacción de runMigrations().
+ *
+ * @return true si la tabla ya estaba convertida o la conversión terminó bien.
+ */
+bool DatabaseManager::migrateDatesToJulianDay() {
+    QSqlQuery query(m_db);
+
+    query.exec("SELECT type FROM pragma_table_info('components') WHERE name = 'fechaAdquisicion'");
+    const bool textDates = query.next() && query.value(0).toString().compare("TEXT", Qt::CaseInsensitive) == 0;
+    query.finish();
+    if (!textDates)
+        return true;
+
+    qInfo() << "Convirtiendo fechas de adquisición a días julianos...";
+
+    query.exec("SELECT seq FROM sqlite_sequence WHERE name = 'components'");
+    const qint64 sequence = query.next() ? query.value(0).toLongLong() : 0;
+    query.finish();
+
+    // QDate::toJulianDay() cuenta días enteros desde el mediodía, julianday() desde la medianoche.
+    const QStringList statements = {
+        "CREATE TABLE components_new ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "nombre TEXT, "
+        "tipo TEXT, "
+        "cantidad INTEGER, "
+        "ubicacion TEXT, "
+        "fechaAdquisicion INTEGER)",
+
+        "INSERT INTO components_new (id, nombre, tipo, cantidad, ubicacion, fechaAdquisicion) "
+        "SELECT id, nombre, tipo, cantidad, ubicacion, "
+        "CAST(julianday(NULLIF(fechaAdquisicion, '')) + 0.5 AS INTEGER) FROM components",
+
+        "DROP TABLE components",
+
+        "ALTER TABLE components_new RENAME TO components",
+
+        QString("UPDATE sqlite_sequence SET seq = %1 WHERE name = 'components' AND seq < %1")
+            .arg(sequence)
+    };
+
+    for (const QString& sql : statements) {
+        if (!query.exec(sql)) {
+            qWarning() << "Error en la migración de fechas:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Crea los índices secundarios usados por las búsquedas por igualdad o rango.
+ * @return true si los índices quedaron creados.
+ */
+bool DatabaseManager::createIndexes() {
+    const QStringList statements = {
+        "CREATE INDEX IF NOT EXISTS idx_components_nombre ON components(nombre)",
+        "CREATE INDEX IF NOT EXISTS idx_components_tipo ON components(tipo)",
+        "CREATE INDEX IF NOT EXISTS idx_components_ubicacion ON components(ubicacion)",
+        "CREATE INDEX IF NOT EXISTS idx_components_cantidad ON components(cantidad)",
+        "CREATE INDEX IF NOT EXISTS idx_components_fecha ON components(fechaAdquisicion)"
+    };
+
+    QSqlQuery query(m_db);
+    for (const QString& sql : statements) {
+        if (!query.exec(sql)) {
+            qWarning() << "Error al crear índice:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Crea el índice de texto completo sobre nombre, tipo y ubicación.
+ *
+ * La tabla FTS5 es de contenido externo (no duplica los textos) y usa el tokenizador
+ * trigram, que permite buscar subcadenas sin distinguir mayúsculas. Tres triggers la
+ * mantienen sincronizada con cada INSERT, UPDATE y DELETE. Si la tabla se acaba de crear
+ * sobre una base con datos, se reconstruye a partir de components.
+ *
+ * El índice es opcional: si SQLite se compiló sin FTS5 la migración se da por aplicada
+ * y las búsquedas recurren a LIKE.
+ *
+ * @return false solo si el índice existe pero no se pudo completar (triggers o reconstrucción).
+ */
+bool DatabaseManager::createFullTextIndex() {
+    QSqlQuery query(m_db);
+
+    query.exec("SELECT 1 FROM sqlite_master WHERE type='table' AND name='components_fts'");
+    const bool exists = query.next();
+    query.finish();
+
+    if (!query.exec("CREATE VIRTUAL TABLE IF NOT EXISTS components_fts USING fts5("
+                    "nombre, tipo, ubicacion, "
+                    "content='components', content_rowid='id', tokenize='trigram')")) {
+        qWarning() << "SQLite sin soporte FTS5 (trigram):" << query.lastError().text();
+        return true;
+    }
+
+    const QStringList statements = {
+
+        "CREATE TRIGGER IF NOT EXISTS components_fts_ai AFTER INSERT ON components BEGIN "
+        "INSERT INTO components_fts(rowid, nombre, tipo, ubicacion) "
+        "VALUES (new.id, new.nombre, new.tipo, new.ubicacion); "
+        "END",
+
+        "CREATE TRIGGER IF NOT EXISTS components_fts_ad AFTER DELETE ON components BEGIN "
+        "INSERT INTO components_fts(components_fts, rowid, nombre, tipo, ubicacion) "
+        "VALUES ('delete', old.id, old.nombre, old.tipo, old.ubicacion); "
+        "END",
+
+        "CREATE TRIGGER IF NOT EXISTS components_fts_au AFTER UPDATE OF nombre, tipo, ubicacion "
+        "ON components BEGIN "
+        "INSERT INTO components_fts(components_fts, rowid, nombre, tipo, ubicacion) "
+        "VALUES ('delete', old.id, old.nombre, old.tipo, old.ubicacion); "
+        "INSERT INTO components_fts(rowid, nombre, tipo, ubicacion) "
+        "VALUES (new.id, new.nombre, new.tipo, new.ubicacion); "
+        "END"
+    };
+
+    for (const QString& sql : statements) {
+        if (!query.exec(sql)) {
+            qWarning() << "Error al crear los triggers del índice de texto completo:"
+                       << query.lastError().text();
+            return false;
+        }
+    }
+
+    if (!exists && !query.exec("INSERT INTO components_fts(components_fts) VALUES('rebuild')")) {
+        qWarning() << "Error al reconstruir el índice de texto completo:" << query.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Mueve los textos de tipo y ubicación a tablas de diccionario.
+ *
+ * Un inventario real tiene pocos cientos de tipos y ubicaciones distintos repetidos en
+ * miles de filas. Tras esta migración cada valor distinto se guarda una sola vez en las
+ * tablas tipos y ubicaciones, y components solo conserva su ID entero (tipo_id,
+ * ubicacion_id), de modo que las filas ocupan menos y los filtros por igualdad comparan
+ * enteros. La vista components_view vuelve a unir los textos para las lecturas.
+ *
+ * La tabla se reconstruye como en migrateDatesToJulianDay() (conservando IDs y el contador
+ * AUTOINCREMENT), así que también se recrean aquí sus índices y, si FTS5 está disponible,
+ * el índice de texto completo, que pasa a leer el contenido de la vista.
+ *
+ * @return true si la conversión terminó bien.
+ */
+bool DatabaseManager::createDictionaryTables() {
+    QSqlQuery query(m_db);
+
+    query.exec("SELECT seq FROM sqlite_sequence WHERE name = 'components'");
+    const qint64 sequence = query.next() ? query.value(0).toLongLong() : 0;
+    query.finish();
+
+    const QStringList statements = {
+        // El índice FTS y sus triggers leen las columnas de texto que se van a eliminar.
+        "DROP TRIGGER IF EXISTS components_fts_ai",
+        "DROP TRIGGER IF EXISTS components_fts_ad",
+        "DROP TRIGGER IF EXISTS components_fts_au",
+        "DROP TABLE IF EXISTS components_fts",
+
+        "CREATE TABLE IF NOT EXISTS tipos (id INTEGER PRIMARY KEY, nombre TEXT NOT NULL UNIQUE)",
+        "CREATE TABLE IF NOT EXISTS ubicaciones (id INTEGER PRIMARY KEY, nombre TEXT NOT NULL UNIQUE)",
+
+        "INSERT OR IGNORE INTO tipos (nombre) "
+        "SELECT DISTINCT tipo FROM components WHERE tipo IS NOT NULL",
+        "INSERT OR IGNORE INTO ubicaciones (nombre) "
+        "SELECT DISTINCT ubicacion FROM components WHERE ubicacion IS NOT NULL",
+
+        "CREATE TABLE components_new ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "nombre TEXT, "
+        "tipo_id INTEGER REFERENCES tipos(id), "
+        "cantidad INTEGER, "
+        "ubicacion_id INTEGER REFERENCES ubicaciones(id), "
+        "fechaAdquisicion INTEGER)",
+
+        "INSERT INTO components_new (id, nombre, tipo_id, cantidad, ubicacion_id, fechaAdquisicion) "
+        "SELECT c.id, c.nombre, t.id, c.cantidad, u.id, c.fechaAdquisicion FROM components c "
+        "LEFT JOIN tipos t ON t.nombre = c.tipo "
+        "LEFT JOIN ubicaciones u ON u.nombre = c.ubicacion",
+
+        "DROP TABLE components",
+
+        "ALTER TABLE components_new RENAME TO components",
+
+        QString("UPDATE sqlite_sequence SET seq = %1 WHERE name = 'components' AND seq < %1")
+            .arg(sequence),
+
+        "CREATE VIEW IF NOT EXISTS components_view AS "
+        "SELECT c.id AS id, c.nombre AS nombre, t.nombre AS tipo, c.cantidad AS cantidad, "
+        "u.nombre AS ubicacion, c.fechaAdquisicion AS fechaAdquisicion, "
+        "c.tipo_id AS tipo_id, c.ubicacion_id AS ubicacion_id "
+        "FROM components c "
+        "LEFT JOIN tipos t ON t.id = c.tipo_id "
+        "LEFT JOIN ubicaciones u ON u.id = c.ubicacion_id",
+
+        "CREATE INDEX IF NOT EXISTS idx_components_nombre ON components(nombre)",
+        "CREATE INDEX IF NOT EXISTS idx_components_tipo ON components(tipo_id)",
+        "CREATE INDEX IF NOT EXISTS idx_components_ubicacion ON components(ubicacion_id)",
+        "CREATE INDEX IF NOT EXISTS idx_components_cantidad ON components(cantidad)",
+        "CREATE INDEX IF NOT EXISTS idx_components_fecha ON components(fechaAdquisicion)"
+    };
+
+    for (const QString& sql : statements) {
+        if (!query.exec(sql)) {
+            qWarning() << "Error en la migración a tablas de diccionario:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    if (!query.exec("CREATE VIRTUAL TABLE components_fts USING fts5("
+                    "nombre, tipo, ubicacion, "
+                    "content='components_view', content_rowid='id', tokenize='trigram')")) {
+        qWarning() << "SQLite sin soporte FTS5 (trigram):" << query.lastError().text();
+        return true;
+    }
+
+    // Las tablas de diccionario solo crecen, así que old.tipo_id sigue resolviendo el texto
+    // que se indexó y el borrado del índice recibe exactamente los mismos valores.
+    const QStringList ftsStatements = {
+        "CREATE TRIGGER components_fts_ai AFTER INSERT ON components BEGIN "
+        "INSERT INTO components_fts(rowid, nombre, tipo, ubicacion) "
+        "VALUES (new.id, new.nombre, "
+        "(SELECT nombre FROM tipos WHERE id = new.tipo_id), "
+        "(SELECT nombre FROM ubicaciones WHERE id = new.ubicacion_id)); "
+        "END",
+
+        "CREATE TRIGGER components_fts_ad AFTER DELETE ON components BEGIN "
+        "INSERT INTO components_fts(components_fts, rowid, nombre, tipo, ubicacion) "
+        "VALUES ('delete', old.id, old.nombre, "
+        "(SELECT nombre FROM tipos WHERE id = old.tipo_id), "
+        "(SELECT nombre FROM ubicaciones WHERE id = old.ubicacion_id)); "
+        "END",
+
+        "CREATE TRIGGER components_fts_au AFTER UPDATE OF nombre, tipo_id, ubicacion_id "
+        "ON components BEGIN "
+        "INSERT INTO components_fts(components_fts, rowid, nombre, tipo, ubicacion) "
+        "VALUES ('delete', old.id, old.nombre, "
+        "(SELECT nombre FROM tipos WHERE id = old.tipo_id), "
+        "(SELECT nombre FROM ubicaciones WHERE id = old.ubicacion_id)); "
+        "INSERT INTO components_fts(rowid, nombre, tipo, ubicacion) "
+        "VALUES (new.id, new.nombre, "
+        "(SELECT nombre FROM tipos WHERE id = new.tipo_id), "
+        "(SELECT nombre FROM ubicaciones WHERE id = new.ubicacion_id)); "
+        "END",
+
+        "INSERT INTO components_fts(components_fts) VALUES('rebuild')"
+    };
+
+    for (const QString& sql : ftsStatements) {
+        if (!query.exec(sql)) {
+            qWarning() << "Error al recrear el índice de texto completo:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Guarda junto a cada texto su clave de búsqueda normalizada.
+ *
+ * SQLite no sabe quitar acentos (NFKD) ni plegar mayúsculas fuera de ASCII, así que las
+ * claves no pueden ser columnas generadas: se calculan en C++ con SearchKey::normalize()
+ * al escribir (bindComponent() y dictionaryId()) y aquí, una sola vez, para las filas
+ * existentes. Las columnas nombre_clave, tipos.clave y ubicaciones.clave tienen índice, de
+ * modo que la igualdad y los prefijos sin acentos usan el índice en lugar de recorrer la
+ * tabla.
+ *
+ * El índice FTS5 pasa a indexar las claves a través de la vista components_keys, que
+ * las expone con los nombres de columna nombre, tipo y ubicacion, así que las consultas
+ * MATCH existentes solo necesitan normalizar la palabra buscada.
+ *
+ * @return true si la conversión terminó bien.
+ */
+bool DatabaseManager::createSearchKeys() {
+    QSqlQuery query(m_db);
+
+    const QStringList statements = {
+        "DROP TRIGGER IF EXISTS components_fts_ai",
+        "DROP TRIGGER IF EXISTS components_fts_ad",
+        "DROP TRIGGER IF EXISTS components_fts_au",
+        "DROP TABLE IF EXISTS components_fts",
+
+        "ALTER TABLE components ADD COLUMN nombre_clave TEXT",
+        "ALTER TABLE tipos ADD COLUMN clave TEXT",
+        "ALTER TABLE ubicaciones ADD COLUMN clave TEXT"
+    };
+    for (const QString& sql : statements) {
+        if (!query.exec(sql)) {
+            qWarning() << "Error al agregar las claves de búsqueda:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    // Calcula la clave de cada fila existente con una sentencia preparada reutilizada.
+    auto backfill = [this](const QString& table, const QString& source, const QString& target) {
+        QSqlQuery select(m_db);
+        select.setForwardOnly(true);
+        QSqlQuery update(m_db);
+        if (!select.exec(QString("SELECT id, %1 FROM %2 WHERE %1 IS NOT NULL").arg(source, table))
+            || !update.prepare(QString("UPDATE %1 SET %2 = ? WHERE id = ?").arg(table, target))) {
+            qWarning() << "Error al calcular las claves de" << table << ":" << select.lastError().text()
+                       << update.lastError().text();
+            return false;
+        }
+        while (select.next()) {
+            update.bindValue(0, SearchKey::normalize(select.value(1).toString()));
+            update.bindValue(1, select.value(0));
+            if (!update.exec()) {
+                qWarning() << "Error al guardar una clave de" << table << ":" << update.lastError().text();
+                return false;
+            }
+        }
+        return true;
+    };
+    if (!backfill("components", "nombre", "nombre_clave")
+        || !backfill("tipos", "nombre", "clave")
+        || !backfill("ubicaciones", "nombre", "clave"))
+        return false;
+
+    const QStringList viewStatements = {
+        "CREATE INDEX IF NOT EXISTS idx_components_nombre_clave ON components(nombre_clave)",
+        "CREATE INDEX IF NOT EXISTS idx_tipos_clave ON tipos(clave)",
+        "CREATE INDEX IF NOT EXISTS idx_ubicaciones_clave ON ubicaciones(clave)",
+
+        "DROP VIEW IF EXISTS components_view",
+        "CREATE VIEW components_view AS "
+        "SELECT c.id AS id, c.nombre AS nombre, t.nombre AS tipo, c.cantidad AS cantidad, "
+        "u.nombre AS ubicacion, c.fechaAdquisicion AS fechaAdquisicion, "
+        "c.tipo_id AS tipo_id, c.ubicacion_id AS ubicacion_id, "
+        "c.nombre_clave AS nombre_clave, t.clave AS tipo_clave, u.clave AS ubicacion_clave "
+        "FROM components c "
+        "LEFT JOIN tipos t ON t.id = c.tipo_id "
+        "LEFT JOIN ubicaciones u ON u.id = c.ubicacion_id",
+
+        "CREATE VIEW IF NOT EXISTS components_keys AS "
+        "SELECT id, nombre_clave AS nombre, tipo_clave AS tipo, ubicacion_clave AS ubicacion "
+        "FROM components_view"
+    };
+    for (const QString& sql : viewStatements) {
+        if (!query.exec(sql)) {
+            qWarning() << "Error al crear las vistas con claves:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    if (!query.exec("CREATE VIRTUAL TABLE components_fts USING fts5("
+                    "nombre, tipo, ubicacion, "
+                    "content='components_keys', content_rowid='id', tokenize='trigram')")) {
+        qWarning() << "SQLite sin soporte FTS5 (trigram):" << query.lastError().text();
+        return true;
+    }
+
+    const QStringList ftsStatements = {
+        "CREATE TRIGGER components_fts_ai AFTER INSERT ON components BEGIN "
+        "INSERT INTO components_fts(rowid, nombre, tipo, ubicacion) "
+        "VALUES (new.id, new.nombre_clave, "
+        "(SELECT clave FROM tipos WHERE id = new.tipo_id), "
+        "(SELECT clave FROM ubicaciones WHERE id = new.ubicacion_id)); "
+        "END",
+
+        "CREATE TRIGGER components_fts_ad AFTER DELETE ON components BEGIN "
+        "INSERT INTO components_fts(components_fts, rowid, nombre, tipo, ubicacion) "
+        "VALUES ('delete', old.id, old.nombre_clave, "
+        "(SELECT clave FROM tipos WHERE id = old.tipo_id), "
+        "(SELECT clave FROM ubicaciones WHERE id = old.ubicacion_id)); "
+        "END",
+
+        "CREATE TRIGGER components_fts_au AFTER UPDATE OF nombre_clave, tipo_id, ubicacion_id "
+        "ON components BEGIN "
+        "INSERT INTO components_fts(components_fts, rowid, nombre, tipo, ubicacion) "
+        "VALUES ('delete', old.id, old.nombre_clave, "
+        "(SELECT clave FROM tipos WHERE id = old.tipo_id), "
+        "(SELECT clave FROM ubicaciones WHERE id = old.ubicacion_id)); "
+        "INSERT INTO components_fts(rowid, nombre, tipo, ubicacion) "
+        "VALUES (new.id, new.nombre_clave, "
+        "(SELECT clave FROM tipos WHERE id = new.tipo_id), "
+        "(SELECT clave FROM ubicaciones WHERE id = new.ubicacion_id)); "
+        "END",
+
+        "INSERT INTO components_fts(components_fts) VALUES('rebuild')"
+    };
+
+    for (const QString& sql : ftsStatements) {
+        if (!query.exec(sql)) {
+            qWarning() << "Error al recrear el índice de texto completo:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Agrega los puntos de reorden de las alertas de bajo stock.
+ *
+ * Ambas columnas admiten NULL, que significa "heredar": un componente sin punto propio usa
+ * el de su tipo, y un tipo sin punto usa el general (AlertEngine::DefaultReorderPoint). No
+ * forman parte de Component ni de components_view, así que editar un componente no borra
+ * su punto de reorden.
+ *
+ * @return true si las columnas existen al terminar.
+ */
+bool DatabaseManager::createReorderPoints() {
+    QSqlQuery query(m_db);
+
+    const QStringList statements = {
+        "ALTER TABLE components ADD COLUMN punto_reorden INTEGER",
+        "ALTER TABLE tipos ADD COLUMN punto_reorden INTEGER"
+    };
+    for (const QString& sql : statements) {
+        if (!query.exec(sql)) {
+            qWarning() << "Error al agregar los puntos de reorden:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Crea la tabla reglas_caducidad.
+ *
+ * Cada regla guarda el tipo tal como se escribió (AlertEngine lo compara por su clave de
+ * búsqueda); un tipo NULL aplica la regla a todos los componentes. Las reglas son pocas y
+ * se leen completas, así que no necesitan índices.
+ *
+ * @return true si la tabla existe al terminar.
+ */
+bool DatabaseManager::createAgeingRules() {
+    QSqlQuery query(m_db);
+    if (!query.exec("CREATE TABLE IF NOT EXISTS reglas_caducidad ("
+                    "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                    "tipo TEXT, "
+                    "meses INTEGER NOT NULL CHECK (meses > 0))")) {
+        qWarning() << "Error al crear la tabla de reglas de caducidad:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Aplica a una conexión recién abierta los PRAGMA configurados.
+ *
+ * journal_mode=WAL es persistente en el archivo, pero se repite en cada conexión por si la
+ * base se creó sin él; synchronous, cache_size y mmap_size son propios de cada conexión.
+ *
+ * @param db Conexión abierta.
+ */
+void DatabaseManager::applyPragmas(QSqlDatabase& db) const {
+    QStringList pragmas;
+    if (m_settings.walMode)
+        pragmas << "PRAGMA journal_mode=WAL";
+    if (!m_settings.synchronous.isEmpty())
+        pragmas << "PRAGMA synchronous=" + m_settings.synchronous;
+    // Un valor negativo de cache_size se interpreta en KiB en lugar de en páginas.
+    pragmas << QString("PRAGMA cache_size=-%1").arg(m_settings.cacheSizeKiB)
+            << QString("PRAGMA mmap_size=%1").arg(m_settings.mmapSize);
+
+    QSqlQuery query(db);
+    for (const QString& pragma : pragmas) {
+        if (!query.exec(pragma))
+            qWarning() << "No se pudo aplicar" << pragma << ":" << query.lastError().text();
+    }
+}
+
+/**
+ * @brief Devuelve la conexión del hilo que llama.
+ *
+ * El hilo propietario usa la conexión principal. Cualquier otro hilo recibe, la primera vez,
+ * un clon con nombre propio ("<conexión>_<hilo>") ya abierto y configurado; las siguientes
+ * llamadas desde ese hilo reutilizan el mismo clon. Cuando el hilo termina, su conexión se
+ * cierra y se elimina del registro de Qt.
+ *
+ * @return Conexión abierta asociada al hilo actual.
+ */
+QSqlDatabase DatabaseManager::connection() {
+    QThread* thread = QThread::currentThread();
+    if (thread == m_ownerThread)
+        return m_db;
+
+    const QString name = m_connectionName + "_" + QString::number(quintptr(thread), 16);
+
+    QMutexLocker locker(&m_poolMutex);
+    if (QSqlDatabase::contains(name))
+        return QSqlDatabase::database(name, false);
+
+    QSqlDatabase db = QSqlDatabase::cloneDatabase(m_connectionName, name);
+    if (!db.open()) {
+        qWarning() << "Error al abrir la conexión del hilo:" << db.lastError().text();
+        return db;
+    }
+    applyPragmas(db);
+
+    // La conexión (y sus sentencias) debe destruirse en el mismo hilo que la usó,
+    // justo antes de que termine.
+    QSharedPointer<StatementCache> statements = m_statements;
+    QObject::connect(thread, &QThread::finished, thread, [name, statements]() {
+        {
+            QMutexLocker statementsLocker(&statements->mutex);
+            statements->byConnection.remove(name);
+        }
+        {
+            QSqlDatabase db = QSqlDatabase::database(name, false);
+            if (db.isOpen())
+                db.close();
+        }
+        QSqlDatabase::removeDatabase(name);
+    }, Qt::DirectConnection);
+
+    return db;
+}
+
+/**
+ * @brief Cierra la conexión principal si está abierta.
+ *
+ * Solo se tocan la conexión del hilo propietario y sus sentencias: Qt no permite usar una
+ * conexión desde un hilo distinto del que la creó, así que las conexiones de otros hilos
+ * las cierra cada hilo al terminar (ver connection()).
  */
 void DatabaseManager::closeDatabase() {
+    {
+        // Las sentencias deben finalizarse antes de cerrar su conexión.
+        QMutexLocker statementsLocker(&m_statements->mutex);
+        m_statements->byConnection.remove(m_connectionName);
+    }
+
+    clearDictionaryIds();
+
     if (m_db.isOpen())
         m_db.close();
 }
 
+/**
+ * @brief Devuelve la sentencia preparada para @p sql en la conexión del hilo actual.
+ *
+ * La primera vez se prepara (y compila) la sentencia y se guarda; las siguientes llamadas
+ * desde la misma conexión devuelven esa instancia, a la que solo hay que volver a enlazar
+ * valores. Una sentencia que no se pudo preparar no se guarda. Si la conexión ya tiene
+ * StatementCache::Capacity sentencias, se descarta la usada hace más tiempo.
+ *
+ * @param sql Texto SQL de la sentencia.
+ * @return Sentencia lista para enlazar y ejecutar, o nula si no se pudo preparar.
+ */
+QSharedPointer<QSqlQuery> DatabaseManager::cachedQuery(const QString& sql) {
+    QSqlDatabase db = connection();
+    const QString name = db.connectionName();
+
+    {
+        QMutexLocker locker(&m_statements->mutex);
+        auto& perConnection = m_statements->byConnection[name];
+        auto it = perConnection.find(sql);
+        if (it != perConnection.end()) {
+            ++m_statements->hits;
+            it.value().lastUse = ++m_statements->clock;
+            return it.value().query;
+        }
+    }
+
+    ++m_statements->misses;
+    QSharedPointer<QSqlQuery> query = QSharedPointer<QSqlQuery>::create(db);
+    query->setForwardOnly(true);
+    if (!query->prepare(sql)) {
+        qWarning() << "Error al preparar la sentencia:" << query->lastError().text();
+        return QSharedPointer<QSqlQuery>();
+    }
+
+    QMutexLocker locker(&m_statements->mutex);
+    auto& perConnection = m_statements->byConnection[name];
+    if (perConnection.size() >= StatementCache::Capacity && !perConnection.contains(sql)) {
+        // Quien aún tenga la sentencia descartada la conserva hasta soltarla.
+        auto oldest = std::min_element(perConnection.begin(), perConnection.end(),
+                                       [](const StatementCache::Entry& a, const StatementCache::Entry& b) {
+                                           return a.lastUse < b.lastUse;
+                                       });
+        perConnection.erase(oldest);
+    }
+    perConnection.insert(sql, {query, ++m_statements->clock});
+    return query;
+}
+
+/**
+ * @brief Número de veces que se reutilizó una sentencia ya preparada.
+ * @return Aciertos de la caché de sentencias.
+ */
+quint64 DatabaseManager::statementCacheHits() const {
+    return m_statements->hits.load();
+}
+
+/**
+ * @brief Número de veces que hubo que preparar una sentencia nueva.
+ * @return Fallos de la caché de sentencias.
+ */
+quint64 DatabaseManager::statementCacheMisses() const {
+    return m_statements->misses.load();
+}
+
+/**
+ * @brief Lee PRAGMA data_version de la conexión principal con una sentencia reutilizable.
+ *
+ * data_version es propio de cada conexión, así que dos lecturas solo son comparables si
+ * salen de la misma; por eso siempre se usa la del hilo propietario y nunca un clon.
+ *
+ * @return Versión de los datos, o -1 si hubo un error o se llamó desde otro hilo.
+ */
+qint64 DatabaseManager::dataVersion() {
+    if (QThread::currentThread() != m_ownerThread) {
+        qWarning() << "data_version solo puede leerse desde el hilo propietario.";
+        return -1;
+    }
+
+    QSharedPointer<QSqlQuery> query = cachedQuery("PRAGMA data_version");
+    if (!query)
+        return -1;
+
+    if (!query->exec() || !query->next()) {
+        qWarning() << "Error al leer data_version:" << query->lastError().text();
+        return -1;
+    }
+    const qint64 version = query->value(0).toLongLong();
+    query->finish();
+    return version;
+}
+
 /**
  * @brief Inserta un nuevo componente en la tabla de base de datos.
  * @param comp Objeto Component con los datos a insertar.
+ * @param newId Si no es nulo, recibe el ID asignado por SQLite.
  * @return true si el insert fue exitoso, false en caso contrario.
  */
-bool DatabaseManager::addComponent(const Component& comp) {
-    QSqlQuery query(m_db);
-    query.prepare(
-        "INSERT INTO components (nombre, tipo, cantidad, ubicacion, fechaAdquisicion) "
-        "VALUES (:nombre, :tipo, :cantidad, :ubicacion, :fecha)"
-        );
-
-    query.bindValue(":nombre", comp.getNombre());
-    query.bindValue(":tipo", comp.getTipo());
-    query.bindValue(":cantidad", comp.getCantidad());
-    query.bindValue(":ubicacion", comp.getUbicacion());
-    query.bindValue(":fecha", comp.getFechaAdquisicion().toString("yyyy-MM-dd"));
+bool DatabaseManager::addComponent(const Component& comp, int* newId) {
+    QSharedPointer<QSqlQuery> query = cachedQuery(kInsertComponentSql);
+    if (!query || !bindComponent(*query, comp))
+        return false;
 
-    bool success = query.exec();
+    bool success = query->exec();
     if (!success)
-        qWarning() << "Error al agregar componente:" << query.lastError().text();
+        qWarning() << "Error al agregar componente:" << query->lastError().text();
+    else if (newId)
+        *newId = query->lastInsertId().toInt();
     return success;
 }
 
+/**
+ * @brief Inserta una lista de componentes en lotes transaccionales.
+ *
+ * Se usa la sentencia de inserción en caché, así que solo se vuelven a enlazar los valores por fila.
+ * Si la confirmación de un lote falla, se revierte y todas sus filas se marcan con -1.
+ *
+ * @param comps Componentes a insertar.
+ * @param batchSize Número de filas por transacción.
+ * @return IDs asignados en el orden de entrada; -1 para las filas fallidas.
+ */
+QList<int> DatabaseManager::addComponents(const QList<Component>& comps, int batchSize) {
+    QList<int> ids;
+    ids.reserve(comps.size());
+
+    if (batchSize <= 0)
+        batchSize = qMax(1, int(comps.size()));
+
+    QSqlDatabase db = connection();
+    QSharedPointer<QSqlQuery> query = cachedQuery(kInsertComponentSql);
+    if (!query)
+        return QList<int>(comps.size(), -1);
+
+    for (int start = 0; start < comps.size(); start += batchSize) {
+        const int end = qMin(start + batchSize, int(comps.size()));
+        const bool inTransaction = db.transaction();
+        if (!inTransaction)
+            qWarning() << "No se pudo iniciar la transacción del lote:" << db.lastError().text();
+
+        for (int i = start; i < end; ++i) {
+            if (bindComponent(*query, comps.at(i)) && query->exec()) {
+                ids.append(query->lastInsertId().toInt());
+            } else {
+                qWarning() << "Error al agregar el componente de la fila" << i << ":"
+                           << query->lastError().text();
+                ids.append(-1);
+            }
+        }
+
+        if (inTransaction && !db.commit()) {
+            qWarning() << "Error al confirmar el lote de componentes:" << db.lastError().text();
+            db.rollback();
+            // Los valores de diccionario insertados en el lote también se revirtieron.
+            clearDictionaryIds();
+            for (int i = start; i < end; ++i)
+                ids[i] = -1;
+        }
+    }
+
+    return ids;
+}
+
 /**
  * @brief Recupera todos los componentes de la base de datos como lista.
  * @return QList<Component> con todos los registros existentes.
  */
 QList<Component> DatabaseManager::getAllComponents() {
     QList<Component> list;
-    QSqlQuery query(m_db);
-    query.exec("SELECT id, nombre, tipo, cantidad, ubicacion, fechaAdquisicion FROM components");
-
-    while (query.next()) {
-        Component c(
-            query.value(0).toInt(),
-            query.value(1).toString(),
-            query.value(2).toString(),
-            query.value(3).toInt(),
-            query.value(4).toString(),
-            QDate::fromString(query.value(5).toString(), "yyyy-MM-dd")
-            );
+    forEachComponent([&list](const Component& c) {
         list.append(c);
+        return true;
+    });
+    return list;
+}
+
+/**
+ * @brief Recorre todos los componentes uno a uno, sin construir una lista.
+ *
+ * Usa una consulta de solo avance (setForwardOnly) propia de esta llamada, de modo que la
+ * memoria no crece con el tamaño del inventario y el visitante puede, a su vez, hacer otras
+ * consultas sobre la base de datos.
+ *
+ * @param visitor Función llamada por cada fila; si devuelve false el recorrido se detiene.
+ * @return true si la consulta se ejecutó correctamente.
+ */
+bool DatabaseManager::forEachComponent(const ComponentVisitor& visitor) {
+    QSqlQuery query(connection());
+    query.setForwardOnly(true);
+    if (!query.exec(QString("SELECT %1 FROM components_view ORDER BY id").arg(kComponentColumns))) {
+        qWarning() << "Error al leer los componentes:" << query.lastError().text();
+        return false;
     }
 
+    visitRows(query, visitor);
+    return true;
+}
+
+/**
+ * @brief Busca un componente por su ID mediante la clave primaria.
+ * @param id ID del componente.
+ * @return El componente, o std::nullopt si no existe.
+ */
+std::optional<Component> DatabaseManager::getComponentById(int id) {
+    const QList<Component> found = selectComponents("id = ?", {id});
+    if (found.isEmpty())
+        return std::nullopt;
+    return found.first();
+}
+
+/**
+ * @brief Recupera un conjunto de componentes por ID en lotes de consultas IN.
+ *
+ * El número de parámetros de cada lote se redondea a la siguiente potencia de dos
+ * (repitiendo el último ID), para que solo existan unas pocas variantes de la sentencia
+ * en la caché de sentencias preparadas.
+ *
+ * @param ids IDs a buscar.
+ * @return Componentes encontrados, ordenados por ID.
+ */
+QList<Component> DatabaseManager::getComponentsByIds(const QList<int>& ids) {
+    constexpr int maxBatch = 512;
+
+    QList<Component> list;
+    for (int start = 0; start < ids.size(); start += maxBatch) {
+        const int count = qMin(maxBatch, int(ids.size()) - start);
+
+        int slots = 1;
+        while (slots < count)
+            slots *= 2;
+
+        QVariantList values;
+        values.reserve(slots);
+        for (int i = 0; i < slots; ++i)
+            values.append(ids.at(start + qMin(i, count - 1)));
+
+        QStringList placeholders;
+        for (int i = 0; i < slots; ++i)
+            placeholders << "?";
+
+        list += selectComponents("id IN (" + placeholders.join(',') + ")", values);
+    }
+
+    if (ids.size() > maxBatch) {
+        std::sort(list.begin(), list.end(), [](const Component& a, const Component& b) {
+            return a.getId() < b.getId();
+        });
+    }
     return list;
 }
 
 /**
- * @brief Busca componentes cuyo nombre, tipo o ubicación coincidan con una palabra clave.
- * @param keyword Palabra clave para buscar.
+ * @brief Recupera una página de componentes continuando después de @p afterKey.
+ *
+ * Se pide una fila más que @p limit para saber si hay páginas posteriores. La condición
+ * de continuación usa una comparación de valores de fila, (columna, id) > (?, ?), que
+ * SQLite resuelve como un rango sobre el índice de la columna (que ya incluye el rowid).
+ * Los valores NULL se ordenan primero, por lo que una clave NULL continúa con el resto de
+ * filas NULL y después con todas las demás.
+ *
+ * Tipo y ubicación son columnas de la vista que vienen de un LEFT JOIN y no tienen índice
+ * propio; esas dos se resuelven en getComponentsPageByDictionary().
+ *
+ * @param afterKey Clave de la última fila entregada (PageKey() para empezar).
+ * @param limit Tamaño máximo de la página.
+ * @param sortColumn Columna de orden.
+ * @return Página de componentes con su clave de continuación.
+ */
+ComponentPage DatabaseManager::getComponentsPage(const PageKey& afterKey, int limit,
+                                                 Component::Field sortColumn) {
+    ComponentPage page;
+    if (limit <= 0)
+        return page;
+
+    if (sortColumn == Component::Field::Tipo || sortColumn == Component::Field::Ubicacion)
+        return getComponentsPageByDictionary(afterKey, limit, sortColumn);
+
+    const QString column = columnName(sortColumn);
+    const bool byId = sortColumn == Component::Field::Id;
+    const bool first = afterKey.id < 0;
+
+    QString where;
+    if (first)
+        where = "1";
+    else if (byId)
+        where = "id > :id";
+    else if (afterKey.value.isNull())
+        where = "(" + column + " IS NULL AND id > :id) OR " + column + " IS NOT NULL";
+    else
+        where = "(" + column + ", id) > (:value, :id)";
+
+    const QString orderBy = byId ? QString("id") : column + ", id";
+
+    QSharedPointer<QSqlQuery> query = cachedQuery(
+        QString("SELECT %1, ").arg(kComponentColumns) + column + " "
+        "FROM components_view WHERE " + where + " ORDER BY " + orderBy + " LIMIT :limit"
+        );
+    if (!query)
+        return page;
+
+    if (!first) {
+        query->bindValue(":id", afterKey.id);
+        if (!byId && !afterKey.value.isNull())
+            query->bindValue(":value", afterKey.value);
+    }
+    query->bindValue(":limit", limit + 1);
+
+    if (!query->exec()) {
+        qWarning() << "Error al leer la página de componentes:" << query->lastError().text();
+        return page;
+    }
+
+    while (query->next()) {
+        if (page.items.size() == limit) {
+            page.hasMore = true;
+            break;
+        }
+        page.items.append(readComponent(*query));
+        page.nextKey.id = query->value(0).toInt();
+        page.nextKey.value = query->value(6);
+    }
+    query->finish();
+
+    if (page.items.isEmpty())
+        page.nextKey = afterKey;
+
+    return page;
+}
+
+/**
+ * @brief Página ordenada por tipo o ubicación recorriendo el diccionario y su ID en components.
+ *
+ * La página se arma en dos tramos que siguen el orden de la vista (NULL primero):
+ *  1. Las filas sin valor, con "tipo_id IS NULL AND id > ?" sobre el índice
+ *     components(tipo_id), que ya incluye el rowid y devuelve las filas por ID.
+ *  2. Las demás, recorriendo el índice UNIQUE del nombre del diccionario en orden y, para
+ *     cada entrada, sus filas por components(tipo_id, id). El CROSS JOIN fija ese orden de
+ *     los bucles, así que ORDER BY nombre, id no necesita ordenar nada y la condición de
+ *     continuación (nombre, id) > (?, ?) empieza directamente en el nombre de la clave.
+ *
+ * El segundo tramo solo se consulta si el primero no llenó la página.
+ *
+ * @param afterKey Clave de la última fila entregada (PageKey() para empezar).
+ * @param limit Tamaño máximo de la página (mayor que 0).
+ * @param sortColumn Component::Field::Tipo o Component::Field::Ubicacion.
+ * @return Página de componentes con su clave de continuación.
+ */
+ComponentPage DatabaseManager::getComponentsPageByDictionary(const PageKey& afterKey, int limit,
+                                                             Component::Field sortColumn) {
+    ComponentPage page;
+
+    const bool byTipo = sortColumn == Component::Field::Tipo;
+    const QString dictionary = byTipo ? "tipos" : "ubicaciones";
+    const QString idColumn = byTipo ? "tipo_id" : "ubicacion_id";
+    const QString other = byTipo ? "ubicaciones" : "tipos";
+    const QString otherIdColumn = byTipo ? "ubicacion_id" : "tipo_id";
+    // Mismo orden que kComponentColumns, más el valor de orden como columna 6
+    const QString columns = byTipo
+        ? "c.id, c.nombre, d.nombre, c.cantidad, o.nombre, c.fechaAdquisicion, d.nombre"
+        : "c.id, c.nombre, o.nombre, c.cantidad, d.nombre, c.fechaAdquisicion, d.nombre";
+    const QString otherJoin = " LEFT JOIN " + other + " o ON o.id = c." + otherIdColumn;
+
+    auto readRows = [&](QSqlQuery& query) {
+        if (!query.exec()) {
+            qWarning() << "Error al leer la página de componentes:" << query.lastError().text();
+            return false;
+        }
+        while (query.next()) {
+            if (page.items.size() == limit) {
+                page.hasMore = true;
+                break;
+            }
+            page.items.append(readComponent(query));
+            page.nextKey.id = query.value(0).toInt();
+            page.nextKey.value = query.value(6);
+        }
+        query.finish();
+        return true;
+    };
+
+    const bool first = afterKey.id < 0;
+    const bool inNulls = first || afterKey.value.isNull();
+
+    // Tramo 1: filas sin tipo/ubicación, por ID
+    if (inNulls) {
+        QSharedPointer<QSqlQuery> query = cachedQuery(
+            "SELECT " + columns + " FROM components c"
+            " LEFT JOIN " + dictionary + " d ON d.id = c." + idColumn + otherJoin +
+            " WHERE c." + idColumn + " IS NULL AND c.id > :id ORDER BY c.id LIMIT :limit"
+            );
+        if (!query)
+            return page;
+        query->bindValue(":id", afterKey.id);
+        query->bindValue(":limit", limit + 1);
+        if (!readRows(*query))
+            return page;
+    }
+
+    // Tramo 2: filas con valor, en el orden del nombre del diccionario
+    if (!page.hasMore) {
+        const QString where = inNulls ? QString() : QString(" WHERE (d.nombre, c.id) > (:value, :id)");
+        QSharedPointer<QSqlQuery> query = cachedQuery(
+            "SELECT " + columns + " FROM " + dictionary + " d"
+            " CROSS JOIN components c ON c." + idColumn + " = d.id" + otherJoin + where +
+            " ORDER BY d.nombre, c.id LIMIT :limit"
+            );
+        if (!query)
+            return page;
+        if (!inNulls) {
+            query->bindValue(":value", afterKey.value);
+            query->bindValue(":id", afterKey.id);
+        }
+        query->bindValue(":limit", limit + 1 - page.items.size());
+        readRows(*query);
+    }
+
+    if (page.items.isEmpty())
+        page.nextKey = afterKey;
+
+    return page;
+}
+
+/**
+ * @brief Busca los componentes que cumplen una consulta compuesta.
+ *
+ * La búsqueda por nombre se resuelve con el índice FTS5 (la frase solo se busca en la
+ * columna nombre) ordenado por bm25; a igual relevancia, por ID.
+ *
+ * @param query Consulta de varios criterios.
+ * @return Lista de componentes coincidentes, ordenados por ID o por relevancia.
+ */
+QList<Component> DatabaseManager::searchComponents(const SearchQuery& query) {
+    if (!query.isValid())
+        return QList<Component>();
+
+    if (query.isRankedByRelevance() && m_ftsEnabled) {
+        QList<Component> list;
+        QSharedPointer<QSqlQuery> ranked = cachedQuery(
+            "SELECT c.id, c.nombre, c.tipo, c.cantidad, c.ubicacion, c.fechaAdquisicion "
+            "FROM components_fts JOIN components_view c ON c.id = components_fts.rowid "
+            "WHERE components_fts MATCH ? ORDER BY bm25(components_fts), c.id"
+            );
+        if (!ranked)
+            return list;
+        ranked->bindValue(0, nombreMatch(query.condition().value.toString()));
+        if (!ranked->exec()) {
+            qWarning() << "Error en búsqueda:" << ranked->lastError().text();
+            return list;
+        }
+        visitRows(*ranked, [&list](const Component& c) {
+            list.append(c);
+            return true;
+        });
+        return list;
+    }
+
+    QVariantList values;
+    const QString where = whereClause(query, values);
+    return selectComponents(where, values);
+}
+
+/**
+ * @brief Busca los componentes con una cantidad exacta.
+ * @param cantidad Cantidad a buscar.
+ * @return Lista de componentes coincidentes.
+ */
+QList<Component> DatabaseManager::searchByQuantity(int cantidad) {
+    return selectComponents("cantidad = ?", {cantidad});
+}
+
+/**
+ * @brief Busca los componentes con una cantidad dentro de un rango (recorrido del índice).
+ * @param min Cantidad mínima incluida.
+ * @param max Cantidad máxima incluida.
+ * @return Lista de componentes coincidentes.
+ */
+QList<Component> DatabaseManager::searchByQuantityRange(int min, int max) {
+    return selectComponents("cantidad BETWEEN ? AND ?", {min, max});
+}
+
+/**
+ * @brief Busca los componentes adquiridos en una fecha concreta.
+ * @param fecha Fecha de adquisición.
+ * @return Lista de componentes coincidentes.
+ */
+QList<Component> DatabaseManager::searchByDate(const QDate& fecha) {
+    return selectComponents("fechaAdquisicion = ?", {fecha.toJulianDay()});
+}
+
+/**
+ * @brief Busca los componentes adquiridos dentro de un rango de fechas.
+ *
+ * Las fechas se guardan como días julianos, así que el filtro es un recorrido por rango
+ * del índice sobre fechaAdquisicion.
+ *
+ * @param from Primera fecha incluida; inválida para no limitar el inicio.
+ * @param to Última fecha incluida; inválida para no limitar el final.
+ * @return Lista de componentes coincidentes, ordenados por ID.
+ */
+QList<Component> DatabaseManager::searchByDateRange(const QDate& from, const QDate& to) {
+    if (from.isValid() && to.isValid())
+        return selectComponents("fechaAdquisicion BETWEEN ? AND ?", {from.toJulianDay(), to.toJulianDay()});
+    if (from.isValid())
+        return selectComponents("fechaAdquisicion >= ?", {from.toJulianDay()});
+    if (to.isValid())
+        return selectComponents("fechaAdquisicion <= ?", {to.toJulianDay()});
+    return selectComponents("fechaAdquisicion IS NOT NULL", {});
+}
+
+/**
+ * @brief Busca los componentes de un tipo exacto.
+ *
+ * El texto se resuelve una vez a su ID en la tabla tipos y la tabla components se filtra
+ * por ese entero, usando el índice sobre tipo_id.
+ *
+ * @param tipo Tipo a buscar (coincidencia exacta).
  * @return Lista de componentes coincidentes.
  */
-QList<Component> DatabaseManager::searchComponents(const QString& keyword) {
+QList<Component> DatabaseManager::searchByTipo(const QString& tipo) {
+    return selectComponents("tipo_id = (SELECT id FROM tipos WHERE nombre = ?)", {tipo});
+}
+
+/**
+ * @brief Busca los componentes guardados en una ubicación exacta.
+ * @param ubicacion Ubicación a buscar (coincidencia exacta).
+ * @return Lista de componentes coincidentes.
+ */
+QList<Component> DatabaseManager::searchByUbicacion(const QString& ubicacion) {
+    return selectComponents("ubicacion_id = (SELECT id FROM ubicaciones WHERE nombre = ?)", {ubicacion});
+}
+
+/**
+ * @brief Componentes con menos stock, recorriendo el índice de cantidad.
+ * @param limit Número de componentes.
+ * @return Componentes ordenados por cantidad creciente.
+ */
+QList<Component> DatabaseManager::lowestStock(int limit) {
+    return selectComponents("cantidad IS NOT NULL", {}, "cantidad, id", std::max(0, limit));
+}
+
+/**
+ * @brief Adquisiciones más recientes, recorriendo el índice de fecha hacia atrás.
+ * @param limit Número de componentes.
+ * @return Componentes ordenados por fecha decreciente.
+ */
+QList<Component> DatabaseManager::mostRecent(int limit) {
+    return selectComponents("fechaAdquisicion IS NOT NULL", {}, "fechaAdquisicion DESC, id DESC",
+                            std::max(0, limit));
+}
+
+/**
+ * @brief Ejecuta un SELECT filtrado sobre la tabla components.
+ * @param where Condición con parámetros posicionales.
+ * @param values Valores de los parámetros, en orden.
+ * @return Componentes que cumplen la condición, ordenados por ID.
+ */
+QList<Component> DatabaseManager::selectComponents(const QString& where, const QVariantList& values,
+                                                   const QString& orderBy, int limit) {
     QList<Component> list;
-    QSqlQuery query(m_db);
-    query.prepare(
-        "SELECT id, nombre, tipo, cantidad, ubicacion, fechaAdquisicion FROM components "
-        "WHERE nombre LIKE :kw OR tipo LIKE :kw OR ubicacion LIKE :kw"
+    QSharedPointer<QSqlQuery> query = cachedQuery(
+        QString("SELECT %1 FROM components_view WHERE ").arg(kComponentColumns) + where
+        + " ORDER BY " + orderBy + (limit >= 0 ? " LIMIT ?" : "")
         );
+    if (!query)
+        return list;
 
-    QString pat = "%" + keyword + "%";
-    query.bindValue(":kw", pat);
+    for (int i = 0; i < values.size(); ++i)
+        query->bindValue(i, values.at(i));
+    if (limit >= 0)
+        query->bindValue(values.size(), limit);
 
-    if (!query.exec()) {
-        qWarning() << "Error en búsqueda:" << query.lastError().text();
+    if (!query->exec()) {
+        qWarning() << "Error en búsqueda:" << query->lastError().text();
         return list;
     }
 
-    while (query.next()) {
-        Component c(
-            query.value(0).toInt(),
-            query.value(1).toString(),
-            query.value(2).toString(),
-            query.value(3).toInt(),
-            query.value(4).toString(),
-            QDate::fromString(query.value(5).toString(), "yyyy-MM-dd")
-            );
+    visitRows(*query, [&list](const Component& c) {
         list.append(c);
-    }
+        return true;
+    });
 
     return list;
 }
@@ -149,23 +1372,24 @@ QList<Component> DatabaseManager::searchComponents(const QString& keyword) {
  * @return true si la actualización fue exitosa.
  */
 bool DatabaseManager::updateComponent(int id, const Component& comp) {
-    QSqlQuery query(m_db);
-    query.prepare(
-        "UPDATE components SET nombre=:nombre, tipo=:tipo, cantidad=:cantidad, "
-        "ubicacion=:ubicacion, fechaAdquisicion=:fecha WHERE id=:id"
+    QSharedPointer<QSqlQuery> query = cachedQuery(
+        "UPDATE components SET nombre=:nombre, nombre_clave=:clave, tipo_id=:tipo, cantidad=:cantidad, "
+        "ubicacion_id=:ubicacion, fechaAdquisicion=:fecha WHERE id=:id"
         );
+    if (!query || !bindComponent(*query, comp))
+        return false;
 
-    query.bindValue(":nombre", comp.getNombre());
-    query.bindValue(":tipo", comp.getTipo());
-    query.bindValue(":cantidad", comp.getCantidad());
-    query.bindValue(":ubicacion", comp.getUbicacion());
-    query.bindValue(":fecha", comp.getFechaAdquisicion().toString("yyyy-MM-dd"));
-    query.bindValue(":id", id);
+    query->bindValue(":id", id);
 
-    bool success = query.exec();
-    if (!success)
-        qWarning() << "Error al actualizar componente:" << query.lastError().text();
-    return success;
+    if (!query->exec()) {
+        qWarning() << "Error al actualizar componente:" << query->lastError().text();
+        return false;
+    }
+    if (query->numRowsAffected() == 0) {
+        qWarning() << "No existe el componente" << id;
+        return false;
+    }
+    return true;
 }
 
 /**
@@ -174,13 +1398,158 @@ bool DatabaseManager::updateComponent(int id, const Component& comp) {
  * @return true si se eliminó correctamente.
  */
 bool DatabaseManager::deleteComponent(int id) {
+    QSharedPointer<QSqlQuery> query = cachedQuery("DELETE FROM components WHERE id=:id");
+    if (!query)
+        return false;
+
+    query->bindValue(":id", id);
+
+    bool success = query->exec();
+    if (!success)
+        qWarning() << "Error al eliminar componente:" << query->lastError().text();
+    return success;
+}
+
+/**
+ * @brief Escribe (o borra con NULL) el punto de reorden de un componente.
+ * @param id ID del componente.
+ * @param point Punto de reorden, o std::nullopt.
+ * @return true si se guardó.
+ */
+bool DatabaseManager::setReorderPoint(int id, std::optional<int> point) {
+    QSharedPointer<QSqlQuery> query = cachedQuery("UPDATE components SET punto_reorden = ? WHERE id = ?");
+    if (!query)
+        return false;
+
+    query->bindValue(0, point ? QVariant(*point) : QVariant());
+    query->bindValue(1, id);
+
+    if (!query->exec()) {
+        qWarning() << "Error al guardar el punto de reorden:" << query->lastError().text();
+        return false;
+    }
+    if (query->numRowsAffected() == 0) {
+        qWarning() << "No existe el componente" << id;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Escribe (o borra con NULL) el punto de reorden de un tipo.
+ *
+ * dictionaryId() asegura que el tipo existe; la actualización se hace por clave para
+ * cubrir todas sus variantes.
+ *
+ * @param tipo Tipo.
+ * @param point Punto de reorden, o std::nullopt.
+ * @return true si se guardó.
+ */
+bool DatabaseManager::setTipoReorderPoint(const QString& tipo, std::optional<int> point) {
+    QVariant tipoId;
+    if (!dictionaryId(Dictionary::Tipos, tipo, tipoId))
+        return false;
+
+    QSharedPointer<QSqlQuery> query = cachedQuery("UPDATE tipos SET punto_reorden = ? WHERE clave = ?");
+    if (!query)
+        return false;
+
+    query->bindValue(0, point ? QVariant(*point) : QVariant());
+    query->bindValue(1, SearchKey::normalize(tipo));
+
+    bool success = query->exec();
+    if (!success)
+        qWarning() << "Error al guardar el punto de reorden del tipo:" << query->lastError().text();
+    return success;
+}
+
+/**
+ * @brief Lee los puntos de reorden no nulos de componentes y tipos.
+ * @param components Destino por ID de componente.
+ * @param tipos Destino por clave de tipo.
+ * @return true si ambas lecturas terminaron bien.
+ */
+bool DatabaseManager::reorderPoints(QHash<int, int>& components, QHash<QString, int>& tipos) {
+    components.clear();
+    tipos.clear();
+
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT id, punto_reorden FROM components WHERE punto_reorden IS NOT NULL")) {
+        qWarning() << "Error al leer los puntos de reorden:" << query.lastError().text();
+        return false;
+    }
+    while (query.next())
+        components.insert(query.value(0).toInt(), query.value(1).toInt());
+
+    if (!query.exec("SELECT clave, punto_reorden FROM tipos WHERE punto_reorden IS NOT NULL")) {
+        qWarning() << "Error al leer los puntos de reorden de los tipos:" << query.lastError().text();
+        return false;
+    }
+    while (query.next())
+        tipos.insert(query.value(0).toString(), query.value(1).toInt());
+    return true;
+}
+
+/**
+ * @brief Lee todas las reglas de caducidad.
+ * @return Reglas; vacía si hubo un error.
+ */
+QList<AlertEngine::AgeingRule> DatabaseManager::ageingRules() {
+    QList<AlertEngine::AgeingRule> rules;
     QSqlQuery query(m_db);
-    query.prepare("DELETE FROM components WHERE id=:id");
-    query.bindValue(":id", id);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT id, tipo, meses FROM reglas_caducidad ORDER BY id")) {
+        qWarning() << "Error al leer las reglas de caducidad:" << query.lastError().text();
+        return rules;
+    }
+    while (query.next())
+        rules.append({query.value(0).toInt(), query.value(1).toString(), query.value(2).toInt()});
+    return rules;
+}
 
-    bool success = query.exec();
+/**
+ * @brief Inserta una regla de caducidad.
+ * @param tipo Tipo, o vacío para todos.
+ * @param meses Meses de antigüedad máxima.
+ * @param newId Recibe el ID nuevo.
+ * @return true si se insertó.
+ */
+bool DatabaseManager::addAgeingRule(const QString& tipo, int meses, int* newId) {
+    QSharedPointer<QSqlQuery> query = cachedQuery(
+        "INSERT INTO reglas_caducidad (tipo, meses) VALUES (?, ?)"
+        );
+    if (!query)
+        return false;
+
+    const QString trimmed = tipo.trimmed();
+    query->bindValue(0, trimmed.isEmpty() ? QVariant() : QVariant(trimmed));
+    query->bindValue(1, meses);
+
+    if (!query->exec()) {
+        qWarning() << "Error al guardar la regla de caducidad:" << query->lastError().text();
+        return false;
+    }
+    if (newId)
+        *newId = query->lastInsertId().toInt();
+    return true;
+}
+
+/**
+ * @brief Borra una regla de caducidad por su ID.
+ * @param id ID de la regla.
+ * @return true si se eliminó correctamente.
+ */
+bool DatabaseManager::deleteAgeingRule(int id) {
+    QSharedPointer<QSqlQuery> query = cachedQuery("DELETE FROM reglas_caducidad WHERE id = ?");
+    if (!query)
+        return false;
+
+    query->bindValue(0, id);
+
+    bool success = query->exec();
     if (!success)
-        qWarning() << "Error al eliminar componente:" << query.lastError().text();
+        qWarning() << "Error al eliminar la regla de caducidad:" << query->lastError().text();
     return success;
 }
 
@@ -190,7 +1559,278 @@ bool DatabaseManager::deleteComponent(int id) {
  */
 QSqlQuery DatabaseManager::getAllComponentQuery()
 {
-    QSqlQuery query;
-    query.exec("SELECT nombre, tipo, cantidad, ubicacion, fechaAdquisicion FROM components");
+    QSqlQuery query(connection());
+    query.setForwardOnly(true);
+    query.exec("SELECT nombre, tipo, cantidad, ubicacion, "
+               "date(fechaAdquisicion - 0.5) AS fechaAdquisicion FROM components_view");
     return query;
 }
+
+/**
+ * @brief Construye la condición SQL de una consulta.
+ *
+ * Cantidad, fecha (como día juliano) e ID se comparan directamente sobre sus columnas
+ * indexadas. Tipo y ubicación se resuelven contra su tabla de diccionario y se comparan
+ * por ID. Para "contiene" sobre el nombre se usa el índice FTS5 cuando existe y el texto
+ * tiene al menos tres caracteres; en otro caso, LIKE con los comodines escapados.
+ *
+ * @param query Consulta válida.
+ * @param values Valores de los parámetros, en orden de aparición.
+ * @return Condición SQL.
+ */
+QString DatabaseManager::whereClause(const SearchQuery& query, QVariantList& values) const {
+    if (query.kind() != SearchQuery::Kind::Condition) {
+        QStringList parts;
+        for (const SearchQuery& part : query.parts())
+            parts << whereClause(part, values);
+        const QString glue = query.kind() == SearchQuery::Kind::And ? " AND " : " OR ";
+        return "(" + parts.join(glue) + ")";
+    }
+
+    const SearchQuery::Condition& condition = query.condition();
+    const QString column = columnName(condition.field);
+
+    // Valor SQL de un extremo: día juliano para las fechas, entero para el resto.
+    auto sqlValue = [&condition](const QVariant& value) -> QVariant {
+        if (condition.field == Component::Field::FechaAdquisicion)
+            return value.toDate().toJulianDay();
+        return value.toInt();
+    };
+    switch (condition.field) {
+    case Component::Field::Id:
+    case Component::Field::Cantidad:
+    case Component::Field::FechaAdquisicion:
+        switch (condition.op) {
+        case SearchQuery::Op::Equals:
+            values << sqlValue(condition.value);
+            return column + " = ?";
+        case SearchQuery::Op::Less:
+            values << sqlValue(condition.value);
+            return column + " < ?";
+        case SearchQuery::Op::Greater:
+            values << sqlValue(condition.value);
+            return column + " > ?";
+        case SearchQuery::Op::Between:
+            if (!condition.value.isNull() && !condition.upper.isNull()) {
+                values << sqlValue(condition.value) << sqlValue(condition.upper);
+                return column + " BETWEEN ? AND ?";
+            }
+            if (!condition.value.isNull()) {
+                values << sqlValue(condition.value);
+                return column + " >= ?";
+            }
+            if (!condition.upper.isNull()) {
+                values << sqlValue(condition.upper);
+                return column + " <= ?";
+            }
+            return column + " IS NOT NULL";
+        default:
+            return "0";
+        }
+
+    case Component::Field::Tipo:
+    case Component::Field::Ubicacion: {
+        const bool tipo = condition.field == Component::Field::Tipo;
+        const QString prefix = tipo ? QString("tipo_id IN (SELECT id FROM tipos WHERE ")
+                                    : QString("ubicacion_id IN (SELECT id FROM ubicaciones WHERE ");
+        return prefix + keyCondition("clave", condition.op, condition.value.toString(), values) + ")";
+    }
+
+    case Component::Field::Nombre: {
+        const QString key = SearchKey::normalize(condition.value.toString());
+        if (condition.op == SearchQuery::Op::Contains && m_ftsEnabled && key.size() >= 3) {
+            values << nombreMatch(key);
+            return "id IN (SELECT rowid FROM components_fts WHERE components_fts MATCH ?)";
+        }
+        return keyCondition("nombre_clave", condition.op, key, values);
+    }
+    }
+    return "0";
+}
+
+/**
+ * @brief Expresión MATCH de FTS5 que busca un texto como frase en la columna nombre.
+ *
+ * La frase va entre comillas (con las comillas internas duplicadas) para que FTS5 no
+ * interprete operadores dentro del texto.
+ *
+ * @param text Texto buscado (se normaliza con SearchKey).
+ * @return Expresión para MATCH.
+ */
+QString DatabaseManager::nombreMatch(const QString& text) {
+    return "nombre : \"" + SearchKey::normalize(text).replace("\"", "\"\"") + "\"";
+}
+
+/**
+ * @brief Traduce una comparación de texto a una condición sobre claves normalizadas.
+ *
+ * La igualdad y el prefijo usan el índice de la columna: el prefijo se expresa como el
+ * rango [clave, clave + U+10FFFF), que en orden binario contiene exactamente las claves que
+ * empiezan por ella. La subcadena usa LIKE, con los comodines del valor escapados.
+ *
+ * @param column Columna de claves.
+ * @param op Operador de texto.
+ * @param text Valor buscado.
+ * @param values Valores de los parámetros.
+ * @return Condición SQL.
+ */
+QString DatabaseManager::keyCondition(const QString& column, SearchQuery::Op op, const QString& text,
+                                      QVariantList& values) {
+    const QString key = SearchKey::normalize(text);
+    switch (op) {
+    case SearchQuery::Op::Equals:
+        values << key;
+        return column + " = ?";
+    case SearchQuery::Op::Prefix:
+        values << key << key + QChar(0xDBFF) + QChar(0xDFFF);
+        return column + " >= ? AND " + column + " < ?";
+    default: {
+        QString pattern = key;
+        pattern.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_");
+        values << "%" + pattern + "%";
+        return column + " LIKE ? ESCAPE '\\'";
+    }
+    }
+}
+
+/**
+ * @brief Enlaza los datos de un componente a una consulta preparada.
+ *
+ * Tipo y ubicación se enlazan como los IDs de su tabla de diccionario, que se crean si el
+ * valor es nuevo.
+ *
+ * @param query Consulta con los parámetros :nombre, :tipo, :cantidad, :ubicacion y :fecha.
+ * @param comp Componente de origen.
+ * @return false si no se pudo obtener el ID de tipo o de ubicación.
+ */
+bool DatabaseManager::bindComponent(QSqlQuery& query, const Component& comp) {
+    QVariant tipoId;
+    QVariant ubicacionId;
+    if (!dictionaryId(Dictionary::Tipos, comp.getTipo(), tipoId)
+        || !dictionaryId(Dictionary::Ubicaciones, comp.getUbicacion(), ubicacionId))
+        return false;
+
+    query.bindValue(":nombre", comp.getNombre());
+    query.bindValue(":clave", comp.getNombre().isNull() ? QVariant() : QVariant(SearchKey::normalize(comp.getNombre())));
+    query.bindValue(":tipo", tipoId);
+    query.bindValue(":cantidad", comp.getCantidad());
+    query.bindValue(":ubicacion", ubicacionId);
+    const QDate fecha = comp.getFechaAdquisicion();
+    query.bindValue(":fecha", fecha.isValid() ? QVariant(fecha.toJulianDay()) : QVariant());
+    return true;
+}
+
+/**
+ * @brief Obtiene el ID de un valor en la tabla tipos o ubicaciones, insertándolo si es nuevo.
+ *
+ * Los IDs ya conocidos se guardan en memoria, de modo que solo el primer uso de cada valor
+ * consulta la base de datos. Un texto nulo se guarda como NULL.
+ *
+ * @param dictionary Tabla de diccionario.
+ * @param value Texto a convertir.
+ * @param id Recibe el ID (o un QVariant nulo si @p value es nulo).
+ * @return true si se obtuvo el ID.
+ */
+bool DatabaseManager::dictionaryId(Dictionary dictionary, const QString& value, QVariant& id) {
+    if (value.isNull()) {
+        id = QVariant();
+        return true;
+    }
+
+    const int index = int(dictionary);
+    {
+        QMutexLocker locker(&m_dictionaryMutex);
+        auto it = m_dictionaryIds[index].constFind(value);
+        if (it != m_dictionaryIds[index].constEnd()) {
+            id = it.value();
+            return true;
+        }
+    }
+
+    const QString table = dictionary == Dictionary::Tipos ? "tipos" : "ubicaciones";
+    QSharedPointer<QSqlQuery> insert = cachedQuery("INSERT OR IGNORE INTO " + table + " (nombre, clave) VALUES (?, ?)");
+    QSharedPointer<QSqlQuery> select = cachedQuery("SELECT id FROM " + table + " WHERE nombre = ?");
+    if (!insert || !select)
+        return false;
+
+    insert->bindValue(0, value);
+    insert->bindValue(1, SearchKey::normalize(value));
+    if (!insert->exec()) {
+        qWarning() << "Error al registrar" << value << "en" << table << ":" << insert->lastError().text();
+        return false;
+    }
+
+    select->bindValue(0, value);
+    if (!select->exec() || !select->next()) {
+        qWarning() << "Error al leer el ID de" << value << "en" << table << ":" << select->lastError().text();
+        return false;
+    }
+    const int found = select->value(0).toInt();
+    select->finish();
+
+    QMutexLocker locker(&m_dictionaryMutex);
+    m_dictionaryIds[index].insert(value, found);
+    id = found;
+    return true;
+}
+
+/**
+ * @brief Olvida los IDs de diccionario guardados en memoria.
+ *
+ * Se usa cuando una transacción revertida pudo descartar valores recién insertados.
+ */
+void DatabaseManager::clearDictionaryIds() {
+    QMutexLocker locker(&m_dictionaryMutex);
+    for (QHash<QString, int>& ids : m_dictionaryIds)
+        ids.clear();
+}
+
+/**
+ * @brief Traduce un campo de Component al nombre de su columna SQL.
+ * @param field Campo del componente.
+ * @return Nombre de la columna.
+ */
+QString DatabaseManager::columnName(Component::Field field) {
+    switch (field) {
+    case Component::Field::Nombre:           return "nombre";
+    case Component::Field::Tipo:             return "tipo";
+    case Component::Field::Cantidad:         return "cantidad";
+    case Component::Field::Ubicacion:        return "ubicacion";
+    case Component::Field::FechaAdquisicion: return "fechaAdquisicion";
+    case Component::Field::Id:               break;
+    }
+    return "id";
+}
+
+/**
+ * @brief Construye un Component a partir de la fila actual de una consulta.
+ *
+ * La consulta debe devolver, en este orden: id, nombre, tipo, cantidad, ubicacion y
+ * fechaAdquisicion.
+ *
+ * @param query Consulta posicionada sobre una fila válida.
+ * @return Componente con los datos de la fila.
+ */
+Component DatabaseManager::readComponent(const QSqlQuery& query) {
+    return Component(
+        query.value(0).toInt(),
+        query.value(1).toString(),
+        query.value(2).toString(),
+        query.value(3).toInt(),
+        query.value(4).toString(),
+        query.value(5).isNull() ? QDate() : QDate::fromJulianDay(query.value(5).toLongLong())
+        );
+}
+
+/**
+ * @brief Entrega al visitante cada fila de una consulta ya ejecutada y la finaliza.
+ * @param query Consulta ejecutada con las columnas esperadas por readComponent().
+ * @param visitor Función llamada por cada fila; si devuelve false se deja de leer.
+ */
+void DatabaseManager::visitRows(QSqlQuery& query, const ComponentVisitor& visitor) {
+    while (query.next()) {
+        if (!visitor(readComponent(query)))
+            break;
+    }
+    query.finish();
+}
@@ -6,23 +6,76 @@
 #include <QList>
 #include <QDate>
 #include <QSqlQuery>
+#include <QVariant>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QHash>
+#include <functional>
+#include <optional>
+#include "alertengine.h"
 #include "component.h"
+#include "searchquery.h"
+
+class QThread;
 
 /// @file databasemanager.h
 /// @brief Declaración de la clase DatabaseManager para gestionar la base de datos del inventario.
 
+/**
+ * @struct DatabaseSettings
+ * @brief Parámetros de rendimiento (PRAGMA) aplicados a cada conexión SQLite.
+ */
+struct DatabaseSettings {
+    bool walMode = true;             ///< Activa journal_mode=WAL para que las lecturas no bloqueen a la escritura.
+    QString synchronous = "NORMAL";  ///< Valor de PRAGMA synchronous (OFF, NORMAL, FULL o EXTRA).
+    int cacheSizeKiB = 65536;        ///< Caché de páginas por conexión, en KiB (PRAGMA cache_size).
+    qint64 mmapSize = 268435456;     ///< Bytes del archivo mapeados en memoria (PRAGMA mmap_size); 0 lo desactiva.
+    int busyTimeoutMs = 5000;        ///< Espera máxima ante un bloqueo de escritura, en milisegundos.
+};
+
+/**
+ * @brief Función que recibe los componentes de un recorrido uno a uno.
+ *
+ * Devuelve true para seguir recibiendo filas o false para detener el recorrido.
+ */
+using ComponentVisitor = std::function<bool(const Component&)>;
+
+/**
+ * @struct PageKey
+ * @brief Posición de corte para la paginación por clave (keyset): la página siguiente empieza
+ * justo después de la fila con este valor de la columna de orden y este ID.
+ */
+struct PageKey {
+    QVariant value; ///< Valor de la columna de orden en la última fila entregada.
+    int id = -1;    ///< ID de la última fila entregada; -1 para pedir la primera página.
+};
+
+/**
+ * @struct ComponentPage
+ * @brief Resultado de una consulta paginada de componentes.
+ */
+struct ComponentPage {
+    QList<Component> items; ///< Componentes de la página, en el orden solicitado.
+    PageKey nextKey;        ///< Clave para pedir la página siguiente.
+    bool hasMore = false;   ///< Indica si existen más filas después de esta página.
+};
+
 /**
  * @class DatabaseManager
  * @brief Clase encargada de manejar la conexión con una base de datos SQLite
  * y realizar operaciones CRUD sobre objetos de tipo Component.
+ *
+ * Cada hilo trabaja con su propia conexión (ver connection()), de modo que los reportes
+ * y búsquedas pueden leer en segundo plano mientras el hilo de la interfaz escribe.
  */
 class DatabaseManager {
 public:
     /**
      * @brief Constructor de la clase.
      * @param path Ruta del archivo de base de datos SQLite.
+     * @param settings Parámetros PRAGMA para las conexiones.
      */
-    explicit DatabaseManager(const QString& path);
+    explicit DatabaseManager(const QString& path, const DatabaseSettings& settings = DatabaseSettings());
 
     /**
      * @brief Destructor. Cierra la base de datos si está abierta.
@@ -30,22 +83,76 @@ public:
     ~DatabaseManager();
 
     /**
-     * @brief Abre la base de datos y crea la tabla si no existe.
+     * @brief Abre la base de datos y aplica las migraciones de esquema pendientes.
      * @return true si se abre correctamente, false si hay error.
      */
     bool openDatabase();
 
     /**
-     * @brief Cierra la base de datos si está abierta.
+     * @brief Versión de esquema (PRAGMA user_version) que corresponde a este programa.
+     * @return Número de la última migración conocida.
+     */
+    static int schemaVersion();
+
+    /**
+     * @brief Cierra la conexión principal; las de otros hilos se cierran al terminar cada hilo.
      */
     void closeDatabase();
 
+    /**
+     * @brief Devuelve la conexión que debe usar el hilo actual.
+     *
+     * El hilo que creó el DatabaseManager usa la conexión principal; cada hilo de trabajo
+     * obtiene su propia conexión con nombre, que se crea bajo demanda y se libera al terminar el hilo.
+     *
+     * @return Conexión abierta para el hilo que llama.
+     */
+    QSqlDatabase connection();
+
+    /**
+     * @brief Número de sentencias CRUD servidas desde la caché de sentencias preparadas.
+     * @return Aciertos acumulados desde la creación del objeto.
+     */
+    quint64 statementCacheHits() const;
+
+    /**
+     * @brief Número de sentencias que hubo que preparar (compilar) por no estar en caché.
+     * @return Fallos acumulados desde la creación del objeto.
+     */
+    quint64 statementCacheMisses() const;
+
+    /**
+     * @brief Valor de PRAGMA data_version en la conexión principal.
+     *
+     * SQLite lo cambia cuando otra conexión (por ejemplo, otro proceso) confirma cambios en
+     * el archivo, pero no por las escrituras de la propia conexión. Como el valor es propio
+     * de cada conexión, solo se lee en la principal: comparar dos lecturas indica si alguien
+     * más modificó la base de datos entretanto. Debe llamarse desde el hilo propietario.
+     *
+     * @return Versión de los datos, o -1 si no se pudo leer o se llamó desde otro hilo.
+     */
+    qint64 dataVersion();
+
     /**
      * @brief Inserta un nuevo componente en la base de datos.
      * @param comp Componente a insertar.
+     * @param newId Si no es nulo, recibe el ID asignado al componente.
      * @return true si la operación fue exitosa.
      */
-    bool addComponent(const Component& comp);
+    bool addComponent(const Component& comp, int* newId = nullptr);
+
+    /**
+     * @brief Inserta varios componentes en bloque (por ejemplo, al importar un catálogo).
+     *
+     * Reutiliza una única sentencia preparada y agrupa las filas en transacciones de
+     * @p batchSize elementos, de modo que cada lote se confirma con una sola escritura a disco.
+     * Una fila que falla no aborta el lote: se registra el error y se continúa con la siguiente.
+     *
+     * @param comps Componentes a insertar.
+     * @param batchSize Número de filas por transacción (si es <= 0 se usa una sola transacción).
+     * @return IDs asignados en el mismo orden que @p comps; -1 en las filas que no se insertaron.
+     */
+    QList<int> addComponents(const QList<Component>& comps, int batchSize = 1000);
 
     /**
      * @brief Recupera todos los componentes almacenados.
@@ -54,11 +161,126 @@ public:
     QList<Component> getAllComponents();
 
     /**
-     * @brief Busca componentes según palabra clave (en nombre, tipo o ubicación).
-     * @param keyword Palabra clave a buscar.
+     * @brief Recorre todos los componentes en orden de ID sin cargarlos en memoria a la vez.
+     *
+     * La consulta es de solo avance, así que la memoria usada es constante sea cual sea el
+     * tamaño del inventario.
+     *
+     * @param visitor Función llamada por cada componente; si devuelve false se detiene.
+     * @return true si la consulta se ejecutó correctamente.
+     */
+    bool forEachComponent(const ComponentVisitor& visitor);
+
+    /**
+     * @brief Busca un componente por su clave primaria.
+     * @param id ID del componente.
+     * @return El componente, o std::nullopt si no existe.
+     */
+    std::optional<Component> getComponentById(int id);
+
+    /**
+     * @brief Recupera varios componentes por sus IDs con consultas IN sobre la clave primaria.
+     * @param ids IDs a buscar (los repetidos o inexistentes se ignoran).
+     * @return Componentes encontrados, ordenados por ID.
+     */
+    QList<Component> getComponentsByIds(const QList<int>& ids);
+
+    /**
+     * @brief Recupera una página de componentes mediante paginación por clave (keyset).
+     *
+     * En lugar de OFFSET, la consulta continúa a partir de la última fila entregada
+     * (columna de orden + ID como desempate) recorriendo el índice de esa columna, de modo
+     * que el coste de cada página no depende de lo avanzada que esté la lectura. Por tipo y
+     * ubicación se recorre el índice del nombre en el diccionario y components(tipo_id) o
+     * components(ubicacion_id), ya que la vista no tiene índice sobre esas columnas.
+     *
+     * @param afterKey Clave devuelta por la página anterior (PageKey() para la primera).
+     * @param limit Número máximo de filas de la página.
+     * @param sortColumn Columna por la que se ordena.
+     * @return Página con los componentes y la clave de continuación.
+     */
+    ComponentPage getComponentsPage(const PageKey& afterKey, int limit,
+                                    Component::Field sortColumn = Component::Field::Id);
+
+    /**
+     * @brief Busca los componentes que cumplen una consulta de varios criterios.
+     *
+     * La consulta se traduce a una única cláusula WHERE parametrizada; el planificador de
+     * SQLite elige el índice más selectivo para cada parte. Si
+     * SearchQuery::isRankedByRelevance() y el índice FTS5 está disponible, se consulta el
+     * índice directamente y se ordena por bm25.
+     *
+     * @param query Consulta válida.
+     * @return Componentes coincidentes, ordenados por ID o por relevancia.
+     */
+    QList<Component> searchComponents(const SearchQuery& query);
+
+    /**
+     * @brief Busca los componentes con una cantidad exacta (usa el índice sobre cantidad).
+     * @param cantidad Cantidad a buscar.
+     * @return Lista de coincidencias.
+     */
+    QList<Component> searchByQuantity(int cantidad);
+
+    /**
+     * @brief Busca los componentes con una cantidad entre dos valores (ambos incluidos).
+     * @param min Cantidad mínima.
+     * @param max Cantidad máxima.
+     * @return Lista de coincidencias.
+     */
+    QList<Component> searchByQuantityRange(int min, int max);
+
+    /**
+     * @brief Busca los componentes adquiridos en una fecha (usa el índice sobre fechaAdquisicion).
+     * @param fecha Fecha de adquisición a buscar.
+     * @return Lista de coincidencias.
+     */
+    QList<Component> searchByDate(const QDate& fecha);
+
+    /**
+     * @brief Busca los componentes adquiridos entre dos fechas (ambas incluidas).
+     * @param from Fecha inicial; una fecha inválida deja el rango abierto por abajo.
+     * @param to Fecha final; una fecha inválida deja el rango abierto por arriba.
+     * @return Lista de coincidencias.
+     */
+    QList<Component> searchByDateRange(const QDate& from, const QDate& to);
+
+    /**
+     * @brief Busca los componentes de un tipo exacto (compara el ID del diccionario de tipos).
+     * @param tipo Tipo a buscar.
+     * @return Lista de coincidencias.
+     */
+    QList<Component> searchByTipo(const QString& tipo);
+
+    /**
+     * @brief Busca los componentes de una ubicación exacta (compara el ID del diccionario de ubicaciones).
+     * @param ubicacion Ubicación a buscar.
      * @return Lista de coincidencias.
      */
-    QList<Component> searchComponents(const QString& keyword);
+    QList<Component> searchByUbicacion(const QString& ubicacion);
+
+    /**
+     * @brief Los @p limit componentes con menos cantidad.
+     *
+     * ORDER BY cantidad, id LIMIT recorre el índice idx_components_cantidad desde el
+     * principio y se detiene al llegar al límite, sin ordenar la tabla.
+     *
+     * @param limit Número de componentes.
+     * @return Componentes de menor a mayor cantidad (a igual cantidad, por ID).
+     */
+    QList<Component> lowestStock(int limit);
+
+    /**
+     * @brief Las @p limit adquisiciones más recientes.
+     *
+     * Recorre el índice idx_components_fecha desde el final; los componentes sin fecha no
+     * se incluyen.
+     *
+     * @param limit Número de componentes.
+     * @return Componentes de la fecha más reciente a la más antigua (a igual fecha, el ID
+     *         mayor primero).
+     */
+    QList<Component> mostRecent(int limit);
 
     /**
      * @brief Proporciona una consulta SQL lista para exportar componentes (por ejemplo, en reportes).
@@ -70,7 +292,8 @@ public:
      * @brief Actualiza un componente existente.
      * @param id ID del componente a actualizar.
      * @param comp Datos actualizados.
-     * @return true si la operación fue exitosa.
+     * @return true si la operación fue exitosa; false también si no existe ningún
+     *         componente con ese ID.
      */
     bool updateComponent(int id, const Component& comp);
 
@@ -81,8 +304,256 @@ public:
      */
     bool deleteComponent(int id);
 
+    /**
+     * @brief Guarda el punto de reorden propio de un componente.
+     * @param id ID del componente.
+     * @param point Punto de reorden, o std::nullopt para heredar el de su tipo.
+     * @return true si se guardó; false si no existe ningún componente con ese ID.
+     */
+    bool setReorderPoint(int id, std::optional<int> point);
+
+    /**
+     * @brief Guarda el punto de reorden de un tipo, registrándolo si aún no existe.
+     *
+     * Se aplica a todas las variantes del tipo con la misma clave de búsqueda (por ejemplo
+     * "Resistor" y "resistor").
+     *
+     * @param tipo Tipo.
+     * @param point Punto de reorden, o std::nullopt para usar el general.
+     * @return true si se guardó.
+     */
+    bool setTipoReorderPoint(const QString& tipo, std::optional<int> point);
+
+    /**
+     * @brief Lee todos los puntos de reorden definidos.
+     * @param components Recibe el punto de cada componente que tiene uno propio, por ID.
+     * @param tipos Recibe el punto de cada tipo que lo tiene, por clave de tipo (SearchKey).
+     * @return true si la lectura terminó bien.
+     */
+    bool reorderPoints(QHash<int, int>& components, QHash<QString, int>& tipos);
+
+    /**
+     * @brief Lee las reglas de caducidad.
+     * @return Reglas ordenadas por ID.
+     */
+    QList<AlertEngine::AgeingRule> ageingRules();
+
+    /**
+     * @brief Guarda una regla de caducidad nueva.
+     * @param tipo Tipo al que se aplica (vacío para todos).
+     * @param meses Antigüedad máxima en meses (mayor que 0).
+     * @param newId Si no es nulo, recibe el ID asignado a la regla.
+     * @return true si se guardó.
+     */
+    bool addAgeingRule(const QString& tipo, int meses, int* newId = nullptr);
+
+    /**
+     * @brief Elimina una regla de caducidad.
+     * @param id ID de la regla.
+     * @return true si la operación fue exitosa.
+     */
+    bool deleteAgeingRule(int id);
+
 private:
-    QSqlDatabase m_db; ///< Instancia de la base de datos SQLite.
+    struct StatementCache;
+
+    /// Tablas de diccionario de la base de datos.
+    enum class Dictionary { Tipos, Ubicaciones };
+
+    /**
+     * @struct Migration
+     * @brief Paso de migración del esquema, identificado por el valor de user_version que deja.
+     */
+    struct Migration {
+        int version;                       ///< Valor de PRAGMA user_version tras aplicarla.
+        const char* description;           ///< Descripción para el log y schema_migrations.
+        bool (DatabaseManager::*apply)();  ///< Función que aplica el cambio sobre m_db.
+    };
+
+    /**
+     * @brief Lista ordenada de migraciones conocidas.
+     * @return Migraciones en orden creciente de versión.
+     */
+    static const QList<Migration>& migrations();
+
+    /**
+     * @brief Aplica en transacciones separadas las migraciones posteriores a user_version
+     * y registra la duración de cada una.
+     * @return true si el esquema quedó actualizado.
+     */
+    bool runMigrations();
+
+    /**
+     * @brief Crea la tabla components si no existe (migración 1).
+     * @return true si la tabla existe al terminar.
+     */
+    bool createComponentsTable();
+
+    /**
+     * @brief Obtiene la sentencia preparada de @p sql para la conexión del hilo actual.
+     *
+     * Cada conexión guarda sus sentencias ya compiladas; solo la primera llamada con un
+     * texto SQL dado paga el coste de prepare().
+     *
+     * @param sql Texto SQL de la sentencia.
+     * @return Sentencia preparada, o nula si la preparación falló.
+     */
+    QSharedPointer<QSqlQuery> cachedQuery(const QString& sql);
+
+    /**
+     * @brief Aplica los PRAGMA de m_settings a una conexión abierta.
+     * @param db Conexión a configurar.
+     */
+    void applyPragmas(QSqlDatabase& db) const;
+
+    /**
+     * @brief Crea la tabla virtual FTS5 que indexa nombre, tipo y ubicación, y los triggers
+     * que la mantienen sincronizada con la tabla components.
+     * @return true si el índice está disponible.
+     */
+    bool createFullTextIndex();
+
+    /**
+     * @brief Construye un Component con la fila actual de una consulta
+     * (id, nombre, tipo, cantidad, ubicacion, fechaAdquisicion).
+     * @param query Consulta posicionada sobre una fila.
+     * @return Componente leído.
+     */
+    static Component readComponent(const QSqlQuery& query);
+
+    /**
+     * @brief Pasa cada fila de una consulta ejecutada al visitante y luego la finaliza.
+     * @param query Consulta ya ejecutada.
+     * @param visitor Función que recibe cada componente.
+     */
+    static void visitRows(QSqlQuery& query, const ComponentVisitor& visitor);
+
+    /**
+     * @brief Nombre de la columna SQL que corresponde a un campo de Component.
+     * @param field Campo del componente.
+     * @return Nombre de la columna en la tabla components.
+     */
+    static QString columnName(Component::Field field);
+
+    /**
+     * @brief Variante de getComponentsPage() para ordenar por tipo o ubicación.
+     * @param afterKey Clave de la última fila entregada.
+     * @param limit Tamaño máximo de la página.
+     * @param sortColumn Component::Field::Tipo o Component::Field::Ubicacion.
+     * @return Página de componentes con su clave de continuación.
+     */
+    ComponentPage getComponentsPageByDictionary(const PageKey& afterKey, int limit,
+                                                Component::Field sortColumn);
+
+    /**
+     * @brief Reconstruye la tabla components de bases antiguas para guardar las fechas
+     * como días julianos (INTEGER) en lugar de texto.
+     * @return true si no hacía falta migrar o la migración terminó bien.
+     */
+    bool migrateDatesToJulianDay();
+
+    /**
+     * @brief Crea los índices B-tree sobre nombre, tipo, ubicacion, cantidad y fechaAdquisicion.
+     * @return true si todos los índices existen al terminar.
+     */
+    bool createIndexes();
+
+    /**
+     * @brief Crea las tablas tipos y ubicaciones, sustituye los textos de components por sus
+     * IDs y crea la vista components_view (migración 5).
+     * @return true si la conversión terminó bien.
+     */
+    bool createDictionaryTables();
+
+    /**
+     * @brief Agrega las claves de búsqueda normalizadas (SearchKey) de nombre, tipo y
+     * ubicación, las calcula para las filas existentes y reconstruye sobre ellas el índice
+     * FTS5 (migración 6).
+     * @return true si la conversión terminó bien.
+     */
+    bool createSearchKeys();
+
+    /**
+     * @brief Agrega las columnas de punto de reorden a components y tipos (migración 7).
+     * @return true si las columnas existen al terminar.
+     */
+    bool createReorderPoints();
+
+    /**
+     * @brief Crea la tabla de reglas de caducidad (migración 8).
+     * @return true si la tabla existe al terminar.
+     */
+    bool createAgeingRules();
+
+    /**
+     * @brief ID de un texto en una tabla de diccionario, creándolo si no existe.
+     * @param dictionary Tabla de diccionario.
+     * @param value Texto a convertir.
+     * @param id Recibe el ID, o un QVariant nulo para un texto nulo.
+     * @return true si se obtuvo el ID.
+     */
+    bool dictionaryId(Dictionary dictionary, const QString& value, QVariant& id);
+
+    /**
+     * @brief Descarta los IDs de diccionario guardados en memoria.
+     */
+    void clearDictionaryIds();
+
+    /**
+     * @brief Ejecuta un SELECT sobre components_view con un filtro parametrizado.
+     * @param where Condición SQL con parámetros posicionales (?).
+     * @param values Valores a enlazar en orden.
+     * @param orderBy Expresión ORDER BY.
+     * @param limit Número máximo de filas, o -1 para no limitar.
+     * @return Componentes que cumplen la condición, en el orden indicado.
+     */
+    QList<Component> selectComponents(const QString& where, const QVariantList& values,
+                                      const QString& orderBy = "id", int limit = -1);
+
+    /**
+     * @brief Traduce una consulta a una condición SQL sobre components_view.
+     * @param query Consulta válida.
+     * @param values Recibe, en orden, los valores de los parámetros posicionales.
+     * @return Condición SQL con parámetros (?).
+     */
+    QString whereClause(const SearchQuery& query, QVariantList& values) const;
+
+    /**
+     * @brief Expresión MATCH de FTS5 para buscar un texto en la columna nombre.
+     * @param text Texto buscado.
+     * @return Frase entre comillas restringida a la columna nombre.
+     */
+    static QString nombreMatch(const QString& text);
+
+    /**
+     * @brief Condición de texto sobre una columna de claves normalizadas.
+     * @param column Columna de claves (nombre_clave o clave).
+     * @param op Equals, Contains o Prefix.
+     * @param text Valor buscado; se normaliza con SearchKey.
+     * @param values Recibe los valores de los parámetros.
+     * @return Fragmento SQL con parámetros posicionales.
+     */
+    static QString keyCondition(const QString& column, SearchQuery::Op op, const QString& text,
+                                QVariantList& values);
+
+    /**
+     * @brief Enlaza los campos de un componente a los parámetros con nombre de una consulta;
+     * :tipo y :ubicacion reciben los IDs de diccionario y :clave la clave normalizada del nombre.
+     * @param query Consulta preparada con :nombre, :clave, :tipo, :cantidad, :ubicacion y :fecha.
+     * @param comp Componente cuyos datos se enlazan.
+     * @return false si no se pudieron resolver los IDs de diccionario.
+     */
+    bool bindComponent(QSqlQuery& query, const Component& comp);
+
+    QString m_connectionName; ///< Nombre de la conexión principal; prefijo de las conexiones por hilo.
+    DatabaseSettings m_settings; ///< Parámetros PRAGMA de las conexiones.
+    QThread* m_ownerThread; ///< Hilo que usa la conexión principal.
+    QMutex m_poolMutex; ///< Protege la creación de conexiones por hilo.
+    QSharedPointer<StatementCache> m_statements; ///< Sentencias preparadas por conexión y contadores de uso.
+    QSqlDatabase m_db; ///< Conexión principal a la base de datos SQLite.
+    bool m_ftsEnabled = false; ///< Indica si el índice FTS5 está disponible para las búsquedas.
+    QMutex m_dictionaryMutex; ///< Protege m_dictionaryIds.
+    QHash<QString, int> m_dictionaryIds[2]; ///< Texto -> ID, por tabla de diccionario (índice Dictionary).
 };
 
 #endif // DATABASEMANAGER_H
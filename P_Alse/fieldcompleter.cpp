@@ -0,0 +1,72 @@
+/**
+ * @file fieldcompleter.cpp
+ * @brief Implementación de la clase FieldCompleter.
+ */
+
+#include "fieldcompleter.h"
+
+/**
+ * @brief Constructor de FieldCompleter.
+ *
+ * El completador se asocia al campo con setWidget() en lugar de QLineEdit::setCompleter()
+ * para controlar cuándo se consulta el índice; al elegir una sugerencia se copia al campo.
+ *
+ * @param manager Gestor del inventario.
+ * @param field Campo cuyos valores se sugieren.
+ * @param edit Campo de texto.
+ */
+FieldCompleter::FieldCompleter(InventoryManager* manager, Component::Field field, QLineEdit* edit)
+    : QCompleter(edit), m_manager(manager), m_field(field), m_edit(edit)
+{
+    m_model = new QStringListModel(this);
+    setModel(m_model);
+    setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    setCaseSensitivity(Qt::CaseInsensitive);
+    setWidget(edit);
+
+    connect(edit, &QLineEdit::textEdited, this, &FieldCompleter::updateSuggestions);
+    connect(this, QOverload<const QString&>::of(&QCompleter::activated), edit, &QLineEdit::setText);
+}
+
+/**
+ * @brief Cambia el campo y descarta las sugerencias anteriores.
+ * @param field Nuevo campo.
+ */
+void FieldCompleter::setField(Component::Field field)
+{
+    m_field = field;
+    m_model->setStringList(QStringList());
+}
+
+/**
+ * @brief Activa o desactiva las sugerencias.
+ * @param active true para sugerir.
+ */
+void FieldCompleter::setActive(bool active)
+{
+    m_active = active;
+    if (!active) {
+        m_model->setStringList(QStringList());
+        popup()->hide();
+    }
+}
+
+/**
+ * @brief Consulta las sugerencias del texto escrito y abre la lista si hay alguna.
+ * @param text Texto actual del campo.
+ */
+void FieldCompleter::updateSuggestions(const QString& text)
+{
+    if (!m_active || text.isEmpty()) {
+        m_model->setStringList(QStringList());
+        popup()->hide();
+        return;
+    }
+
+    const QStringList suggestions = m_manager->completions(m_field, text, MaxSuggestions);
+    m_model->setStringList(suggestions);
+    if (suggestions.isEmpty() || (suggestions.size() == 1 && suggestions.first() == text))
+        popup()->hide();
+    else
+        complete();
+}
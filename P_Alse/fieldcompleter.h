@@ -0,0 +1,63 @@
+/**
+ * @file fieldcompleter.h
+ * @brief Declaración de la clase FieldCompleter, autocompletado de campos del inventario.
+ */
+
+#ifndef FIELDCOMPLETER_H
+#define FIELDCOMPLETER_H
+
+#include <QCompleter>
+#include <QLineEdit>
+#include <QStringListModel>
+#include "inventorymanager.h"
+
+/**
+ * @class FieldCompleter
+ * @brief Autocompletado de un QLineEdit con los valores existentes de un campo.
+ *
+ * En cada edición pide a InventoryManager las sugerencias más usadas que empiezan por el
+ * texto escrito y las muestra tal cual (sin volver a filtrarlas), de modo que el coste por
+ * pulsación es el de una consulta al índice de prefijos.
+ */
+class FieldCompleter : public QCompleter {
+    Q_OBJECT
+
+public:
+    /// Número de sugerencias que se muestran.
+    static constexpr int MaxSuggestions = 10;
+
+    /**
+     * @brief Crea el autocompletado y lo conecta al campo de texto.
+     * @param manager Gestor del inventario que proporciona las sugerencias.
+     * @param field Campo cuyos valores se sugieren (Nombre, Tipo o Ubicacion).
+     * @param edit Campo de texto; también es el padre del objeto.
+     */
+    FieldCompleter(InventoryManager* manager, Component::Field field, QLineEdit* edit);
+
+    /**
+     * @brief Cambia el campo cuyos valores se sugieren.
+     * @param field Nuevo campo.
+     */
+    void setField(Component::Field field);
+
+    /**
+     * @brief Activa o desactiva las sugerencias (por ejemplo, al buscar por cantidad).
+     * @param active true para sugerir.
+     */
+    void setActive(bool active);
+
+private:
+    /**
+     * @brief Actualiza las sugerencias con el texto editado y muestra la lista.
+     * @param text Texto actual del campo.
+     */
+    void updateSuggestions(const QString& text);
+
+    InventoryManager* m_manager;   /**< Gestor del inventario. */
+    Component::Field m_field;      /**< Campo cuyos valores se sugieren. */
+    QLineEdit* m_edit;             /**< Campo de texto asociado. */
+    QStringListModel* m_model;     /**< Sugerencias actuales. */
+    bool m_active = true;          /**< Indica si se deben mostrar sugerencias. */
+};
+
+#endif // FIELDCOMPLETER_H
@@ -0,0 +1,97 @@
+/// @file fuzzymatcher.cpp
+/// @brief Implementación de la clase FuzzyMatcher.
+
+#include "fuzzymatcher.h"
+#include "searchkey.h"
+#include <algorithm>
+
+/**
+ * @brief Construye la tabla de máscaras del patrón (Peq en la notación de Myers).
+ * @param pattern Texto buscado.
+ */
+FuzzyMatcher::FuzzyMatcher(const QString& pattern)
+    : m_pattern(SearchKey::normalize(pattern).left(MaxPatternLength))
+{
+    for (int i = 0; i < m_pattern.size(); ++i) {
+        const char16_t c = m_pattern.at(i).unicode();
+        const quint64 bit = quint64(1) << i;
+        if (c < m_ascii.size())
+            m_ascii[c] |= bit;
+        else
+            m_other[c] |= bit;
+    }
+}
+
+/**
+ * @brief Errores tolerados por defecto: más cuanto más largo es el patrón.
+ * @return Entre 1 y 3.
+ */
+int FuzzyMatcher::defaultMaxErrors() const
+{
+    return std::clamp((m_pattern.size() + 1) / 4, 1, 3);
+}
+
+/**
+ * @brief Recorre el texto actualizando los vectores de diferencias verticales.
+ *
+ * La primera fila de la matriz es cero (el patrón puede empezar en cualquier posición del
+ * texto), por eso el acarreo horizontal no introduce un 1 en el bit inferior. La puntuación
+ * sigue la última fila; el mínimo a lo largo del texto es la distancia buscada.
+ *
+ * @param text Clave normalizada del texto en el que se busca.
+ * @param maxErrors Cota a partir de la cual el resultado exacto no interesa.
+ * @return Distancia de edición.
+ */
+int FuzzyMatcher::distance(const QString& text, int maxErrors) const
+{
+    const int m = m_pattern.size();
+    if (m == 0)
+        return 0;
+
+    const quint64 last = quint64(1) << (m - 1);
+    quint64 pv = ~quint64(0);
+    quint64 mv = 0;
+    int score = m;
+    int best = m;
+
+    const int n = text.size();
+    for (int j = 0; j < n; ++j) {
+        const quint64 eq = mask(text.at(j).unicode());
+        const quint64 xv = eq | mv;
+        const quint64 xh = (((eq & pv) + pv) ^ pv) | eq;
+        quint64 ph = mv | ~(xh | pv);
+        quint64 mh = pv & xh;
+
+        if (ph & last)
+            ++score;
+        else if (mh & last)
+            --score;
+
+        ph <<= 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        if (score < best) {
+            best = score;
+            if (best == 0)
+                break;
+        }
+        // La puntuación baja como mucho 1 por carácter: si ni así llega a la cota, se corta.
+        if (score - (n - j - 1) > maxErrors && best > maxErrors)
+            break;
+    }
+    return best;
+}
+
+/**
+ * @brief Busca la máscara de un carácter: tabla directa para ASCII, hash para el resto.
+ * @param c Carácter de la clave.
+ * @return Máscara, 0 si no aparece en el patrón.
+ */
+quint64 FuzzyMatcher::mask(char16_t c) const
+{
+    if (c < m_ascii.size())
+        return m_ascii[c];
+    return m_other.value(c, 0);
+}
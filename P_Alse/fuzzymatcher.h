@@ -0,0 +1,74 @@
+#ifndef FUZZYMATCHER_H
+#define FUZZYMATCHER_H
+
+#include <QHash>
+#include <QString>
+#include <array>
+
+/// @file fuzzymatcher.h
+/// @brief Declaración de la clase FuzzyMatcher, distancia de edición bit-paralela (Myers/Hyyrö).
+
+/**
+ * @class FuzzyMatcher
+ * @brief Calcula la distancia de edición entre un patrón fijo y muchos textos.
+ *
+ * Usa el algoritmo bit-paralelo de Myers en la formulación de Hyyrö: cada columna de la
+ * matriz de programación dinámica se representa con vectores de bits de diferencias
+ * verticales, de modo que procesar un carácter del texto cuesta unas pocas operaciones
+ * sobre una palabra de 64 bits en lugar de m sumas. Por eso el patrón se limita a sus
+ * primeros 64 caracteres.
+ *
+ * La distancia es la de búsqueda aproximada: el menor número de inserciones, borrados o
+ * sustituciones para que el patrón aparezca en alguna parte del texto (un nombre que
+ * contiene el patrón tal cual tiene distancia 0). El patrón se normaliza con SearchKey y
+ * se compara con claves ya normalizadas, así que no se distinguen mayúsculas ni acentos.
+ *
+ * Las tablas se construyen una vez en el constructor; distance() es de solo lectura y se
+ * puede llamar desde varios hilos a la vez.
+ */
+class FuzzyMatcher {
+public:
+    /// Longitud máxima del patrón (bits de una palabra).
+    static constexpr int MaxPatternLength = 64;
+
+    /**
+     * @brief Prepara el patrón.
+     * @param pattern Texto buscado; se normaliza (SearchKey) y se recorta a MaxPatternLength.
+     */
+    explicit FuzzyMatcher(const QString& pattern);
+
+    /**
+     * @brief Patrón efectivo (normalizado y recortado).
+     * @return Patrón.
+     */
+    const QString& pattern() const { return m_pattern; }
+
+    /**
+     * @brief Número de errores tolerados por defecto según la longitud del patrón.
+     * @return 1 hasta 7 caracteres, 2 hasta 11 y 3 a partir de ahí.
+     */
+    int defaultMaxErrors() const;
+
+    /**
+     * @brief Distancia de edición del patrón a su mejor aparición en @p text.
+     * @param text Clave normalizada (SearchKey::normalize) del texto en el que se busca.
+     * @param maxErrors Si el resultado supera este valor, se puede devolver cualquier
+     *        número mayor que él (el recorrido se corta en cuanto no puede mejorar).
+     * @return Distancia, entre 0 y la longitud del patrón.
+     */
+    int distance(const QString& text, int maxErrors = MaxPatternLength) const;
+
+private:
+    /**
+     * @brief Máscara de posiciones del patrón donde aparece un carácter.
+     * @param c Carácter.
+     * @return Bit i a 1 si el carácter i del patrón es @p c.
+     */
+    quint64 mask(char16_t c) const;
+
+    QString m_pattern;                 ///< Patrón normalizado.
+    std::array<quint64, 128> m_ascii{}; ///< Máscaras de los caracteres ASCII.
+    QHash<char16_t, quint64> m_other;  ///< Máscaras del resto de caracteres.
+};
+
+#endif // FUZZYMATCHER_H
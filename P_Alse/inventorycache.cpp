@@ -0,0 +1,1194 @@
+/// @file inventorycache.cpp
+/// @brief Implementación de la clase InventoryCache.
+
+#include "inventorycache.h"
+#include "scankernels.h"
+#include "searchkey.h"
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+/// Filas mínimas por fragmento: con menos, repartir el trabajo cuesta más que hacerlo.
+constexpr int kParallelGrain = 16384;
+
+/**
+ * @struct Chunk
+ * @brief Tramo [begin, end) de un recorrido paralelo y las filas que aceptó.
+ */
+struct Chunk {
+    int begin = 0;      ///< Primera posición del tramo.
+    int end = 0;        ///< Posición siguiente a la última.
+    QVector<int> rows;  ///< Filas aceptadas, en orden.
+};
+
+/**
+ * @brief Divide [0, count) en tramos para el grupo de hilos global.
+ *
+ * Se crean hasta cuatro tramos por hilo para que los hilos que terminan antes tomen los
+ * pendientes, pero nunca tramos de menos de kParallelGrain posiciones.
+ *
+ * @param count Número de posiciones.
+ * @param alignment Múltiplo al que se redondea el tamaño de cada tramo.
+ * @return Tramos consecutivos (uno solo si no compensa repartir).
+ */
+QVector<Chunk> makeChunks(int count, int alignment = 1)
+{
+    const int threads = std::max(1, QThreadPool::globalInstance()->maxThreadCount());
+    const int pieces = std::max(1, std::min(threads * 4, count / kParallelGrain));
+
+    int step = (count + pieces - 1) / pieces;
+    step = std::max(alignment, (step + alignment - 1) / alignment * alignment);
+
+    QVector<Chunk> chunks;
+    for (int begin = 0; begin < count || chunks.isEmpty(); begin += step) {
+        Chunk chunk;
+        chunk.begin = begin;
+        chunk.end = std::min(count, begin + step);
+        chunks.append(chunk);
+    }
+    return chunks;
+}
+
+/**
+ * @brief Ejecuta @p work sobre cada tramo: en el hilo actual si hay uno solo, y si no,
+ * repartidos en el grupo de hilos global, esperando a que terminen todos.
+ * @param chunks Tramos.
+ * @param work Función que procesa un tramo.
+ */
+template <typename Work>
+void runChunks(QVector<Chunk>& chunks, const Work& work)
+{
+    if (chunks.size() == 1)
+        work(chunks.first());
+    else
+        QtConcurrent::blockingMap(chunks, work);
+}
+
+/**
+ * @brief Filtra filas en paralelo conservando el orden.
+ *
+ * Cada tramo guarda sus filas aceptadas y al final se concatenan en el orden de los
+ * tramos, así que el resultado es el mismo que el de un recorrido secuencial.
+ *
+ * @param candidates Filas a comprobar (ordenadas), o nullptr para comprobar 0..count-1.
+ * @param count Número de posiciones a recorrer.
+ * @param accept Predicado sobre una fila; debe poder llamarse desde varios hilos a la vez.
+ * @return Filas aceptadas, en orden.
+ */
+template <typename Predicate>
+QVector<int> filterRows(const QVector<int>* candidates, int count, const Predicate& accept)
+{
+    QVector<Chunk> chunks = makeChunks(count);
+    runChunks(chunks, [candidates, &accept](Chunk& chunk) {
+        for (int i = chunk.begin; i < chunk.end; ++i) {
+            const int row = candidates ? candidates->at(i) : i;
+            if (accept(row))
+                chunk.rows.append(row);
+        }
+    });
+
+    if (chunks.size() == 1)
+        return chunks.first().rows;
+
+    int total = 0;
+    for (const Chunk& chunk : chunks)
+        total += chunk.rows.size();
+    QVector<int> rows;
+    rows.reserve(total);
+    for (const Chunk& chunk : chunks)
+        rows += chunk.rows;
+    return rows;
+}
+}
+
+//=======================================================================
+// Estado de la caché
+//=======================================================================
+
+/**
+ * @brief Vacía todos los arreglos y diccionarios.
+ */
+void InventoryCache::clear()
+{
+    m_ids.clear();
+    m_cantidades.clear();
+    m_fechas.clear();
+    m_tipos.clear();
+    m_ubicaciones.clear();
+    m_nombres.clear();
+    m_nombreClaves.clear();
+    m_tokenTotal = 0;
+    m_tipoDict = Dictionary();
+    m_ubicacionDict = Dictionary();
+    m_idsByTipo.clear();
+    m_idsByUbicacion.clear();
+    m_byCantidad.clear();
+    m_byFecha.clear();
+    m_nombreTrigrams.clear();
+    m_nombrePrefixes.clear();
+    m_tipoPrefixes.clear();
+    m_ubicacionPrefixes.clear();
+    m_loaded = false;
+}
+
+/**
+ * @brief Indica si la caché está completa.
+ * @return true si se cargó desde la base de datos.
+ */
+bool InventoryCache::isLoaded() const
+{
+    return m_loaded;
+}
+
+/**
+ * @brief Marca la caché como cargada.
+ */
+void InventoryCache::markLoaded()
+{
+    m_loaded = true;
+}
+
+/**
+ * @brief Número de filas de la caché.
+ * @return Cantidad de componentes.
+ */
+int InventoryCache::size() const
+{
+    return m_ids.size();
+}
+
+//=======================================================================
+// Escritura
+//=======================================================================
+
+namespace {
+/**
+ * @brief Agrega un ID a una lista ordenada.
+ * @param ids Lista ordenada de IDs.
+ * @param id ID a agregar; normalmente mayor que todos, así que se añade al final.
+ */
+void insertSorted(QVector<int>& ids, int id)
+{
+    if (ids.isEmpty() || ids.constLast() < id)
+        ids.append(id);
+    else
+        ids.insert(std::lower_bound(ids.begin(), ids.end(), id), id);
+}
+
+/**
+ * @brief Quita un ID de una lista ordenada.
+ * @param ids Lista ordenada de IDs.
+ * @param id ID a quitar.
+ */
+void removeSorted(QVector<int>& ids, int id)
+{
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    if (it != ids.end() && *it == id)
+        ids.erase(it);
+}
+
+/**
+ * @brief Quita un ID de la lista de un código y borra la lista si queda vacía.
+ * @param index Índice código -> IDs.
+ * @param code Código.
+ * @param id ID a quitar.
+ */
+void removeFromCode(QHash<int, QVector<int>>& index, int code, int id)
+{
+    auto it = index.find(code);
+    if (it == index.end())
+        return;
+    removeSorted(it.value(), id);
+    if (it.value().isEmpty())
+        index.erase(it);
+}
+}
+
+/**
+ * @brief Agrega un componente conservando el orden por ID.
+ *
+ * Los IDs nuevos de SQLite (AUTOINCREMENT) son siempre mayores que los existentes, así que
+ * el caso habitual es añadir al final de cada arreglo.
+ *
+ * @param comp Componente con ID asignado.
+ */
+void InventoryCache::insert(const Component& comp)
+{
+    const int id = comp.getId();
+    auto it = std::lower_bound(m_ids.begin(), m_ids.end(), id);
+    const int row = int(it - m_ids.begin());
+
+    if (it != m_ids.end() && *it == id) {
+        unindexRow(row);
+        assign(row, comp);
+        indexRow(row);
+        return;
+    }
+
+    m_ids.insert(row, id);
+    m_cantidades.insert(row, 0);
+    m_fechas.insert(row, NoDate);
+    m_tipos.insert(row, 0);
+    m_ubicaciones.insert(row, 0);
+    m_nombres.insert(row, QString());
+    m_nombreClaves.insert(row, QString());
+    assign(row, comp);
+    indexRow(row);
+}
+
+/**
+ * @brief Actualiza la fila del componente con el mismo ID.
+ *
+ * Solo se tocan los índices de los campos que cambian: una edición de cantidad no pasa por
+ * los trigramas ni por los PrefixIndex, y un cambio de nombre solo agrega y quita los
+ * trigramas que difieren entre la clave anterior y la nueva.
+ *
+ * @param comp Datos nuevos.
+ * @return true si el componente estaba en la caché.
+ */
+bool InventoryCache::update(const Component& comp)
+{
+    const int row = rowOf(comp.getId());
+    if (row < 0)
+        return false;
+
+    const int id = comp.getId();
+    const int tokensBefore = rowTokens(row);
+    const QString nombre = comp.getNombre();
+    if (nombre != m_nombres.at(row)) {
+        const QString clave = SearchKey::normalize(nombre);
+        if (clave != m_nombreClaves.at(row))
+            m_nombreTrigrams.replace(id, m_nombreClaves.at(row), clave);
+        m_nombrePrefixes.remove(m_nombres.at(row));
+        m_nombrePrefixes.insert(nombre);
+        m_nombres[row] = nombre;
+        m_nombreClaves[row] = clave;
+    }
+
+    const int tipo = m_tipoDict.intern(comp.getTipo());
+    if (tipo != m_tipos.at(row)) {
+        removeFromCode(m_idsByTipo, m_tipos.at(row), id);
+        insertSorted(m_idsByTipo[tipo], id);
+        m_tipoPrefixes.remove(m_tipoDict.values.at(m_tipos.at(row)));
+        m_tipoPrefixes.insert(m_tipoDict.values.at(tipo));
+        m_tipos[row] = tipo;
+    }
+
+    const int ubicacion = m_ubicacionDict.intern(comp.getUbicacion());
+    if (ubicacion != m_ubicaciones.at(row)) {
+        removeFromCode(m_idsByUbicacion, m_ubicaciones.at(row), id);
+        insertSorted(m_idsByUbicacion[ubicacion], id);
+        m_ubicacionPrefixes.remove(m_ubicacionDict.values.at(m_ubicaciones.at(row)));
+        m_ubicacionPrefixes.insert(m_ubicacionDict.values.at(ubicacion));
+        m_ubicaciones[row] = ubicacion;
+    }
+
+    if (comp.getCantidad() != m_cantidades.at(row)) {
+        m_byCantidad.erase({m_cantidades.at(row), id});
+        m_byCantidad.emplace(comp.getCantidad(), id);
+        m_cantidades[row] = comp.getCantidad();
+    }
+
+    const qint32 fecha = toDay(comp.getFechaAdquisicion());
+    if (fecha != m_fechas.at(row)) {
+        m_byFecha.erase({m_fechas.at(row), id});
+        if (fecha != NoDate)
+            m_byFecha.emplace(fecha, id);
+        m_fechas[row] = fecha;
+    }
+    m_tokenTotal += rowTokens(row) - tokensBefore;
+    return true;
+}
+
+/**
+ * @brief Elimina la fila de un ID desplazando las posteriores.
+ * @param id ID del componente.
+ * @return true si el componente estaba en la caché.
+ */
+bool InventoryCache::remove(int id)
+{
+    const int row = rowOf(id);
+    if (row < 0)
+        return false;
+
+    unindexRow(row);
+    m_ids.remove(row);
+    m_cantidades.remove(row);
+    m_fechas.remove(row);
+    m_tipos.remove(row);
+    m_ubicaciones.remove(row);
+    m_nombres.remove(row);
+    m_nombreClaves.remove(row);
+    return true;
+}
+
+/**
+ * @brief Copia los campos de un componente en una fila.
+ * @param row Fila destino.
+ * @param comp Componente de origen.
+ */
+void InventoryCache::assign(int row, const Component& comp)
+{
+    m_cantidades[row] = comp.getCantidad();
+    m_fechas[row] = toDay(comp.getFechaAdquisicion());
+    m_tipos[row] = m_tipoDict.intern(comp.getTipo());
+    m_ubicaciones[row] = m_ubicacionDict.intern(comp.getUbicacion());
+    m_nombres[row] = comp.getNombre();
+    m_nombreClaves[row] = SearchKey::normalize(comp.getNombre());
+}
+
+/**
+ * @brief Cuenta los trigramas de las tres claves de texto de una fila.
+ *
+ * El tokenizador trigram de FTS5 produce un token por posición, así que un texto de n
+ * caracteres tiene n - 2 (ninguno si es más corto que tres).
+ *
+ * @param row Fila.
+ * @return Trigramas de la fila.
+ */
+int InventoryCache::rowTokens(int row) const
+{
+    auto trigrams = [](const QString& key) { return std::max(0, int(key.size()) - 2); };
+    return trigrams(m_nombreClaves.at(row))
+        + trigrams(m_tipoDict.keys.at(m_tipos.at(row)))
+        + trigrams(m_ubicacionDict.keys.at(m_ubicaciones.at(row)));
+}
+
+
+/**
+ * @brief Registra la fila en los índices de tipo, ubicación, cantidad y fecha.
+ * @param row Fila con sus datos ya asignados.
+ */
+void InventoryCache::indexRow(int row)
+{
+    const int id = m_ids.at(row);
+    insertSorted(m_idsByTipo[m_tipos.at(row)], id);
+    insertSorted(m_idsByUbicacion[m_ubicaciones.at(row)], id);
+    m_byCantidad.emplace(m_cantidades.at(row), id);
+    if (m_fechas.at(row) != NoDate)
+        m_byFecha.emplace(m_fechas.at(row), id);
+    m_nombreTrigrams.insert(id, m_nombreClaves.at(row));
+    m_tokenTotal += rowTokens(row);
+    m_nombrePrefixes.insert(m_nombres.at(row));
+    m_tipoPrefixes.insert(m_tipoDict.values.at(m_tipos.at(row)));
+    m_ubicacionPrefixes.insert(m_ubicacionDict.values.at(m_ubicaciones.at(row)));
+}
+
+/**
+ * @brief Quita la fila de los índices usando sus valores actuales.
+ * @param row Fila indexada.
+ */
+void InventoryCache::unindexRow(int row)
+{
+    const int id = m_ids.at(row);
+
+    removeFromCode(m_idsByTipo, m_tipos.at(row), id);
+    removeFromCode(m_idsByUbicacion, m_ubicaciones.at(row), id);
+
+    m_byCantidad.erase({m_cantidades.at(row), id});
+    m_byFecha.erase({m_fechas.at(row), id});
+    m_nombreTrigrams.remove(id, m_nombreClaves.at(row));
+    m_tokenTotal -= rowTokens(row);
+    m_nombrePrefixes.remove(m_nombres.at(row));
+    m_tipoPrefixes.remove(m_tipoDict.values.at(m_tipos.at(row)));
+    m_ubicacionPrefixes.remove(m_ubicacionDict.values.at(m_ubicaciones.at(row)));
+}
+
+//=======================================================================
+// Lectura
+//=======================================================================
+
+/**
+ * @brief Calcula el bm25 (sin la IDF, común a todas las filas) de cada fila y las ordena.
+ *
+ * La frecuencia es el número de apariciones de la clave en el nombre, contando las que se
+ * solapan, igual que las posiciones en las que FTS5 encuentra la frase.
+ *
+ * @param rows Filas coincidentes, en orden de ID.
+ * @param keyword Subcadena buscada.
+ */
+void InventoryCache::rankByNombreRelevance(QVector<int>& rows, const QString& keyword) const
+{
+    const QString key = SearchKey::normalize(keyword);
+    if (key.isEmpty() || rows.size() < 2 || m_tokenTotal <= 0)
+        return;
+
+    constexpr double k1 = 1.2;
+    constexpr double b = 0.75;
+    const double averageTokens = double(m_tokenTotal) / m_ids.size();
+
+    QVector<std::pair<double, int>> scored;
+    scored.reserve(rows.size());
+    for (int row : rows) {
+        const QString& nombre = m_nombreClaves.at(row);
+        int frequency = 0;
+        for (int at = nombre.indexOf(key); at >= 0; at = nombre.indexOf(key, at + 1))
+            ++frequency;
+        const double norm = k1 * (1 - b + b * rowTokens(row) / averageTokens);
+        scored.append({-(frequency * (k1 + 1) / (frequency + norm)), row});
+    }
+
+    // Las filas están en orden de ID, así que a igual relevancia se desempata por ID.
+    std::sort(scored.begin(), scored.end());
+    for (int i = 0; i < scored.size(); ++i)
+        rows[i] = scored.at(i).second;
+}
+
+/**
+ * @brief Localiza la fila de un ID por búsqueda binaria.
+ * @param id ID del componente.
+ * @return Fila, o -1 si no existe.
+ */
+int InventoryCache::rowOf(int id) const
+{
+    auto it = std::lower_bound(m_ids.cbegin(), m_ids.cend(), id);
+    if (it == m_ids.cend() || *it != id)
+        return -1;
+    return int(it - m_ids.cbegin());
+}
+
+/**
+ * @brief Construye el Component de una fila.
+ * @param row Fila válida.
+ * @return Componente reconstruido.
+ */
+Component InventoryCache::componentAt(int row) const
+{
+    const qint32 day = m_fechas.at(row);
+    return Component(m_ids.at(row),
+                     m_nombres.at(row),
+                     m_tipoDict.values.at(m_tipos.at(row)),
+                     m_cantidades.at(row),
+                     m_ubicacionDict.values.at(m_ubicaciones.at(row)),
+                     day == NoDate ? QDate() : QDate::fromJulianDay(day));
+}
+
+/**
+ * @brief Busca un componente por ID.
+ * @param id ID del componente.
+ * @return El componente, o std::nullopt si no existe.
+ */
+std::optional<Component> InventoryCache::component(int id) const
+{
+    const int row = rowOf(id);
+    if (row < 0)
+        return std::nullopt;
+    return componentAt(row);
+}
+
+/**
+ * @brief Reconstruye todos los componentes en orden de ID.
+ * @return Lista completa.
+ */
+QList<Component> InventoryCache::components() const
+{
+    QList<Component> list(size());
+    Component* out = list.data();
+    QVector<Chunk> chunks = makeChunks(size());
+    runChunks(chunks, [this, out](Chunk& chunk) {
+        for (int row = chunk.begin; row < chunk.end; ++row)
+            out[row] = componentAt(row);
+    });
+    return list;
+}
+
+/**
+ * @brief Reconstruye los componentes de un conjunto de filas.
+ * @param rows Filas a reconstruir.
+ * @return Componentes en el orden de @p rows.
+ */
+QList<Component> InventoryCache::components(const QVector<int>& rows) const
+{
+    QList<Component> list(rows.size());
+    Component* out = list.data();
+    QVector<Chunk> chunks = makeChunks(rows.size());
+    runChunks(chunks, [this, &rows, out](Chunk& chunk) {
+        for (int i = chunk.begin; i < chunk.end; ++i)
+            out[i] = componentAt(rows.at(i));
+    });
+    return list;
+}
+
+//=======================================================================
+// Filtros
+//=======================================================================
+
+/**
+ * @brief Convierte una lista ordenada de IDs en sus filas.
+ *
+ * Como IDs y filas siguen el mismo orden, cada búsqueda binaria empieza donde terminó la
+ * anterior.
+ *
+ * @param ids IDs ordenados.
+ * @return Filas ordenadas.
+ */
+QVector<int> InventoryCache::rowsOfIds(const QVector<int>& ids) const
+{
+    QVector<int> rows;
+    rows.reserve(ids.size());
+    auto from = m_ids.cbegin();
+    for (int id : ids) {
+        from = std::lower_bound(from, m_ids.cend(), id);
+        if (from == m_ids.cend())
+            break;
+        if (*from == id)
+            rows.append(int(from - m_ids.cbegin()));
+    }
+    return rows;
+}
+
+/**
+ * @brief Filas cuyo nombre contiene el texto indicado.
+ * @param keyword Texto a buscar.
+ * @return Filas en orden de ID.
+ */
+QVector<int> InventoryCache::rowsWhereNombreContains(const QString& keyword) const
+{
+    return rowsWhereNombre(SearchQuery::Op::Contains, keyword);
+}
+
+/**
+ * @brief Búsqueda aproximada de nombres con filtro de trigramas y clasificación parcial.
+ * @param matcher Patrón preparado.
+ * @param maxErrors Errores tolerados.
+ * @param limit Número máximo de resultados.
+ * @return Los @p limit resultados más parecidos.
+ */
+QVector<InventoryCache::FuzzyHit> InventoryCache::rowsWhereNombreNear(const FuzzyMatcher& matcher,
+                                                                      int maxErrors, int limit) const
+{
+    QVector<FuzzyHit> hits;
+    const QString& pattern = matcher.pattern();
+    if (pattern.isEmpty() || limit <= 0)
+        return hits;
+
+    const int minShared = TrigramIndex::trigramCount(pattern) - 3 * maxErrors;
+    const std::optional<QVector<int>> candidates = m_nombreTrigrams.candidatesSharing(pattern, minShared);
+    const QString* names = m_nombreClaves.constData();
+    auto near = [names, &matcher, maxErrors](int row) {
+        return matcher.distance(names[row], maxErrors) <= maxErrors;
+    };
+
+    QVector<int> rows;
+    if (candidates) {
+        const QVector<int> candidateRows = rowsOfIds(*candidates);
+        rows = filterRows(&candidateRows, candidateRows.size(), near);
+    } else {
+        rows = filterRows(nullptr, size(), near);
+    }
+
+    hits.reserve(rows.size());
+    for (int row : rows)
+        hits.append(FuzzyHit{row, matcher.distance(names[row], maxErrors)});
+
+    auto closer = [names, &pattern](const FuzzyHit& a, const FuzzyHit& b) {
+        if (a.distance != b.distance)
+            return a.distance < b.distance;
+        const int extraA = std::abs(int(names[a.row].size() - pattern.size()));
+        const int extraB = std::abs(int(names[b.row].size() - pattern.size()));
+        if (extraA != extraB)
+            return extraA < extraB;
+        return a.row < b.row;
+    };
+    if (hits.size() > limit) {
+        std::partial_sort(hits.begin(), hits.begin() + limit, hits.end(), closer);
+        hits.resize(limit);
+    } else {
+        std::sort(hits.begin(), hits.end(), closer);
+    }
+    return hits;
+}
+
+/**
+ * @brief Filas cuyo nombre cumple una comparación de texto.
+ *
+ * Un nombre igual al valor, que empieza por él o que lo contiene incluye todos sus
+ * trigramas, así que el índice sirve para los tres operadores.
+ *
+ * El valor se normaliza una vez y se compara con las claves ya normalizadas de los nombres.
+ *
+ * @param op Operador de texto.
+ * @param text Valor de la condición.
+ * @return Filas en orden de ID.
+ */
+QVector<int> InventoryCache::rowsWhereNombre(SearchQuery::Op op, const QString& text) const
+{
+    const QString value = SearchKey::normalize(text);
+    const std::optional<QVector<int>> candidates = m_nombreTrigrams.candidates(value);
+    const QString* names = m_nombreClaves.constData();
+    auto matches = [names, op, &value](int row) {
+        return textMatches(names[row], op, value);
+    };
+
+    if (!candidates)
+        return filterRows(nullptr, size(), matches);
+
+    // Tener todos los trigramas no garantiza que estén seguidos: se verifica cada candidato.
+    const QVector<int> rows = rowsOfIds(*candidates);
+    return filterRows(&rows, rows.size(), matches);
+}
+
+/**
+ * @brief Filas cuyo tipo contiene el texto indicado.
+ * @param keyword Texto a buscar.
+ * @return Filas en orden de ID.
+ */
+QVector<int> InventoryCache::rowsWhereTipoContains(const QString& keyword) const
+{
+    return rowsWithCodes(m_idsByTipo, m_tipoDict.matching(SearchQuery::Op::Contains, keyword));
+}
+
+/**
+ * @brief Filas cuya ubicación contiene el texto indicado.
+ * @param keyword Texto a buscar.
+ * @return Filas en orden de ID.
+ */
+QVector<int> InventoryCache::rowsWhereUbicacionContains(const QString& keyword) const
+{
+    return rowsWithCodes(m_idsByUbicacion, m_ubicacionDict.matching(SearchQuery::Op::Contains, keyword));
+}
+
+/**
+ * @brief Filas con un tipo exacto, leídas del índice de tipos.
+ * @param tipo Tipo a buscar.
+ * @return Filas en orden de ID.
+ */
+QVector<int> InventoryCache::rowsWhereTipoIs(const QString& tipo) const
+{
+    const int code = m_tipoDict.codes.value(tipo, -1);
+    return code < 0 ? QVector<int>() : rowsOfIds(m_idsByTipo.value(code));
+}
+
+/**
+ * @brief Filas con una ubicación exacta.
+ * @param ubicacion Ubicación a buscar.
+ * @return Filas en orden de ID.
+ */
+QVector<int> InventoryCache::rowsWhereUbicacionIs(const QString& ubicacion) const
+{
+    const int code = m_ubicacionDict.codes.value(ubicacion, -1);
+    return code < 0 ? QVector<int>() : rowsOfIds(m_idsByUbicacion.value(code));
+}
+
+/**
+ * @brief Filas con cantidad dentro de un rango, leídas del índice ordenado de cantidades.
+ * @param min Límite inferior incluido.
+ * @param max Límite superior incluido.
+ * @return Filas en orden de ID.
+ */
+QVector<int> InventoryCache::rowsWhereCantidadBetween(int min, int max) const
+{
+    return rowsInRange(m_byCantidad, m_cantidades, min, max);
+}
+
+/**
+ * @brief Filas con fecha dentro de un rango de días julianos.
+ * @param from Primer día incluido.
+ * @param to Último día incluido.
+ * @return Filas en orden de ID.
+ */
+QVector<int> InventoryCache::rowsWhereFechaBetween(qint32 from, qint32 to) const
+{
+    // La columna guarda NoDate en las filas sin fecha; el rango nunca debe incluirlo.
+    if (from == NoDate)
+        from = NoDate + 1;
+    return rowsInRange(m_byFecha, m_fechas, from, to);
+}
+
+/**
+ * @brief Primeras @p k entradas del índice de cantidades.
+ * @param k Número de filas.
+ * @return Filas en orden de cantidad.
+ */
+QVector<int> InventoryCache::rowsWithLowestCantidad(int k) const
+{
+    QVector<int> rows;
+    rows.reserve(std::max(0, std::min(k, size())));
+    for (auto it = m_byCantidad.cbegin(); it != m_byCantidad.cend() && rows.size() < k; ++it)
+        rows.append(rowOf(it->second));
+    return rows;
+}
+
+/**
+ * @brief Últimas @p k entradas del índice de fechas.
+ * @param k Número de filas.
+ * @return Filas de la más a la menos reciente.
+ */
+QVector<int> InventoryCache::rowsWithLatestFecha(int k) const
+{
+    QVector<int> rows;
+    rows.reserve(std::max(0, std::min(k, int(m_byFecha.size()))));
+    for (auto it = m_byFecha.crbegin(); it != m_byFecha.crend() && rows.size() < k; ++it)
+        rows.append(rowOf(it->second));
+    return rows;
+}
+
+//=======================================================================
+// Consultas de varios criterios
+//=======================================================================
+
+namespace {
+/// A partir de este número de filas, el recuento de un rango se da por poco selectivo.
+constexpr qint64 kRangeCountLimit = 4096;
+
+/// Ajusta un límite de 64 bits al rango de qint32.
+qint32 clampToInt(qint64 value)
+{
+    return qint32(qBound<qint64>(std::numeric_limits<qint32>::min(), value,
+                                 std::numeric_limits<qint32>::max()));
+}
+}
+
+/**
+ * @brief Ejecuta una consulta sobre los índices y columnas de la caché.
+ * @param query Consulta.
+ * @return Filas coincidentes en orden de ID.
+ */
+QVector<int> InventoryCache::rowsWhere(const SearchQuery& query) const
+{
+    if (!query.isValid())
+        return QVector<int>();
+
+    switch (query.kind()) {
+    case SearchQuery::Kind::Condition:
+        return rowsWhere(query.condition());
+
+    case SearchQuery::Kind::Or: {
+        QVector<int> rows;
+        for (const SearchQuery& part : query.parts())
+            rows += rowsWhere(part);
+        std::sort(rows.begin(), rows.end());
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+        return rows;
+    }
+
+    case SearchQuery::Kind::And: {
+        std::vector<SearchQuery> parts = query.parts();
+        std::vector<qint64> estimates;
+        estimates.reserve(parts.size());
+        for (const SearchQuery& part : parts)
+            estimates.push_back(estimateRows(part));
+
+        // La parte más selectiva elige las filas; el resto se comprueba solo sobre ellas.
+        const auto best = std::min_element(estimates.cbegin(), estimates.cend()) - estimates.cbegin();
+        QVector<int> rows = rowsWhere(parts.at(best));
+        parts.erase(parts.begin() + best);
+        if (parts.empty() || rows.isEmpty())
+            return rows;
+
+        const RowPredicate rest = compile(SearchQuery::allOf(parts));
+        return filterRows(&rows, rows.size(), rest);
+    }
+    }
+    return QVector<int>();
+}
+
+/**
+ * @brief Resuelve una condición con el índice de su campo.
+ * @param condition Condición.
+ * @return Filas en orden de ID.
+ */
+QVector<int> InventoryCache::rowsWhere(const SearchQuery::Condition& condition) const
+{
+    switch (condition.field) {
+    case Component::Field::Id: {
+        qint64 min, max;
+        integerBounds(condition, min, max);
+        QVector<int> rows;
+        if (min > max)
+            return rows;
+        // Las filas están ordenadas por ID: el rango de IDs es un tramo contiguo de filas.
+        const int first = int(std::lower_bound(m_ids.cbegin(), m_ids.cend(), clampToInt(min)) - m_ids.cbegin());
+        const int last = int(std::upper_bound(m_ids.cbegin(), m_ids.cend(), clampToInt(max)) - m_ids.cbegin());
+        rows.reserve(last - first);
+        for (int row = first; row < last; ++row)
+            rows.append(row);
+        return rows;
+    }
+    case Component::Field::Cantidad:
+    case Component::Field::FechaAdquisicion: {
+        qint64 min, max;
+        integerBounds(condition, min, max);
+        if (min > max)
+            return QVector<int>();
+        return condition.field == Component::Field::Cantidad
+                   ? rowsWhereCantidadBetween(clampToInt(min), clampToInt(max))
+                   : rowsWhereFechaBetween(clampToInt(min), clampToInt(max));
+    }
+    case Component::Field::Tipo:
+        return rowsWithCodes(m_idsByTipo, m_tipoDict.matching(condition.op, condition.value.toString()));
+    case Component::Field::Ubicacion:
+        return rowsWithCodes(m_idsByUbicacion, m_ubicacionDict.matching(condition.op, condition.value.toString()));
+    case Component::Field::Nombre:
+        return rowsWhereNombre(condition.op, condition.value.toString());
+    }
+    return QVector<int>();
+}
+
+/**
+ * @brief Estima cuántas filas devuelve una consulta sin ejecutarla.
+ *
+ * Los diccionarios y los índices de trigramas dan la cifra directamente; los rangos de
+ * cantidad y fecha se cuentan en su índice ordenado hasta un límite, a partir del cual se
+ * consideran poco selectivos.
+ *
+ * @param query Consulta.
+ * @return Filas estimadas.
+ */
+qint64 InventoryCache::estimateRows(const SearchQuery& query) const
+{
+    if (query.kind() == SearchQuery::Kind::And) {
+        qint64 estimate = size();
+        for (const SearchQuery& part : query.parts())
+            estimate = std::min(estimate, estimateRows(part));
+        return estimate;
+    }
+    if (query.kind() == SearchQuery::Kind::Or) {
+        qint64 estimate = 0;
+        for (const SearchQuery& part : query.parts())
+            estimate += estimateRows(part);
+        return std::min<qint64>(estimate, size());
+    }
+
+    const SearchQuery::Condition& condition = query.condition();
+    switch (condition.field) {
+    case Component::Field::Id: {
+        qint64 min, max;
+        integerBounds(condition, min, max);
+        if (min > max)
+            return 0;
+        return std::upper_bound(m_ids.cbegin(), m_ids.cend(), clampToInt(max))
+               - std::lower_bound(m_ids.cbegin(), m_ids.cend(), clampToInt(min));
+    }
+    case Component::Field::Cantidad:
+    case Component::Field::FechaAdquisicion: {
+        qint64 min, max;
+        integerBounds(condition, min, max);
+        if (min > max)
+            return 0;
+
+        const auto& index = condition.field == Component::Field::Cantidad ? m_byCantidad : m_byFecha;
+        qint64 count = 0;
+        for (auto it = index.lower_bound({clampToInt(min), std::numeric_limits<int>::min()});
+             it != index.cend() && it->first <= max; ++it) {
+            if (++count >= kRangeCountLimit)
+                return size();
+        }
+        return count;
+    }
+    case Component::Field::Tipo:
+    case Component::Field::Ubicacion: {
+        const bool tipo = condition.field == Component::Field::Tipo;
+        const QVector<bool> matches = (tipo ? m_tipoDict : m_ubicacionDict)
+                                          .matching(condition.op, condition.value.toString());
+        const CodeIndex& index = tipo ? m_idsByTipo : m_idsByUbicacion;
+        qint64 count = 0;
+        for (auto it = index.cbegin(); it != index.cend(); ++it) {
+            if (it.key() < matches.size() && matches.at(it.key()))
+                count += it.value().size();
+        }
+        return count;
+    }
+    case Component::Field::Nombre: {
+        const int estimate = m_nombreTrigrams.estimate(SearchKey::normalize(condition.value.toString()));
+        return estimate < 0 ? size() : estimate;
+    }
+    }
+    return size();
+}
+
+/**
+ * @brief Compila una consulta en un predicado que lee directamente las columnas.
+ *
+ * Cada condición captura sus valores ya convertidos (límites enteros, códigos de
+ * diccionario aceptados) y un puntero a su columna, de modo que evaluar una fila no
+ * interpreta la consulta de nuevo.
+ *
+ * @param query Consulta válida.
+ * @return Predicado sobre filas.
+ */
+InventoryCache::RowPredicate InventoryCache::compile(const SearchQuery& query) const
+{
+    if (query.kind() != SearchQuery::Kind::Condition) {
+        std::vector<std::pair<qint64, RowPredicate>> compiled;
+        for (const SearchQuery& part : query.parts())
+            compiled.emplace_back(estimateRows(part), compile(part));
+
+        QVector<RowPredicate> predicates;
+        if (query.kind() == SearchQuery::Kind::And) {
+            // Primero las partes que descartan más filas.
+            std::stable_sort(compiled.begin(), compiled.end(),
+                             [](const auto& a, const auto& b) { return a.first < b.first; });
+            for (const auto& part : compiled)
+                predicates.append(part.second);
+            return [predicates](int row) {
+                for (const RowPredicate& predicate : predicates) {
+                    if (!predicate(row))
+                        return false;
+                }
+                return true;
+            };
+        }
+
+        // En OR, primero las partes que aceptan más filas.
+        std::stable_sort(compiled.begin(), compiled.end(),
+                         [](const auto& a, const auto& b) { return a.first > b.first; });
+        for (const auto& part : compiled)
+            predicates.append(part.second);
+        return [predicates](int row) {
+            for (const RowPredicate& predicate : predicates) {
+                if (predicate(row))
+                    return true;
+            }
+            return false;
+        };
+    }
+
+    const SearchQuery::Condition& condition = query.condition();
+    switch (condition.field) {
+    case Component::Field::Id:
+    case Component::Field::Cantidad:
+    case Component::Field::FechaAdquisicion: {
+        qint64 min, max;
+        integerBounds(condition, min, max);
+        const qint32* column = condition.field == Component::Field::Id ? m_ids.constData()
+                             : condition.field == Component::Field::Cantidad ? m_cantidades.constData()
+                                                                             : m_fechas.constData();
+        return [column, min, max](int row) {
+            return column[row] >= min && column[row] <= max;
+        };
+    }
+    case Component::Field::Tipo:
+    case Component::Field::Ubicacion: {
+        const bool tipo = condition.field == Component::Field::Tipo;
+        const QVector<bool> matches = (tipo ? m_tipoDict : m_ubicacionDict)
+                                          .matching(condition.op, condition.value.toString());
+        const int* codes = tipo ? m_tipos.constData() : m_ubicaciones.constData();
+        return [codes, matches](int row) {
+            return matches.at(codes[row]);
+        };
+    }
+    case Component::Field::Nombre: {
+        const QString* names = m_nombreClaves.constData();
+        const SearchQuery::Op op = condition.op;
+        const QString value = SearchKey::normalize(condition.value.toString());
+        return [names, op, value](int row) {
+            return textMatches(names[row], op, value);
+        };
+    }
+    }
+    return [](int) { return false; };
+}
+
+/**
+ * @brief Traduce una condición numérica o de fecha a un intervalo cerrado.
+ *
+ * Las fechas se convierten a días julianos; el intervalo nunca incluye NoDate, así que los
+ * componentes sin fecha no cumplen ninguna condición sobre la fecha.
+ *
+ * @param condition Condición sobre Id, Cantidad o FechaAdquisicion.
+ * @param min Límite inferior incluido.
+ * @param max Límite superior incluido (menor que @p min si no hay valores posibles).
+ */
+void InventoryCache::integerBounds(const SearchQuery::Condition& condition, qint64& min, qint64& max)
+{
+    const bool fecha = condition.field == Component::Field::FechaAdquisicion;
+    auto toInteger = [fecha](const QVariant& value) -> qint64 {
+        return fecha ? qint64(toDay(value.toDate())) : qint64(value.toInt());
+    };
+
+    min = fecha ? qint64(NoDate) + 1 : qint64(std::numeric_limits<qint32>::min());
+    max = std::numeric_limits<qint32>::max();
+
+    switch (condition.op) {
+    case SearchQuery::Op::Equals:
+        min = max = toInteger(condition.value);
+        break;
+    case SearchQuery::Op::Less:
+        max = toInteger(condition.value) - 1;
+        break;
+    case SearchQuery::Op::Greater:
+        min = toInteger(condition.value) + 1;
+        break;
+    case SearchQuery::Op::Between:
+        if (!condition.value.isNull())
+            min = toInteger(condition.value);
+        if (!condition.upper.isNull())
+            max = toInteger(condition.upper);
+        break;
+    case SearchQuery::Op::Contains:
+    case SearchQuery::Op::Prefix:
+        max = min - 1;
+        break;
+    }
+
+    if (fecha && min <= NoDate)
+        min = qint64(NoDate) + 1;
+}
+
+/**
+ * @brief Aplica un operador de texto sobre claves ya normalizadas (comparación binaria).
+ * @param key Clave almacenada.
+ * @param op Operador.
+ * @param value Clave del valor buscado.
+ * @return true si coincide.
+ */
+bool InventoryCache::textMatches(const QString& key, SearchQuery::Op op, const QString& value)
+{
+    switch (op) {
+    case SearchQuery::Op::Equals:   return key == value;
+    case SearchQuery::Op::Contains: return key.contains(value);
+    case SearchQuery::Op::Prefix:   return key.startsWith(value);
+    default:                        return false;
+    }
+}
+
+/**
+ * @brief Sugerencias de autocompletado del índice de prefijos del campo.
+ * @param field Campo de texto.
+ * @param prefix Texto escrito.
+ * @param limit Número máximo de sugerencias.
+ * @return Sugerencias ordenadas por frecuencia.
+ */
+QStringList InventoryCache::completions(Component::Field field, const QString& prefix, int limit)
+{
+    switch (field) {
+    case Component::Field::Nombre:
+        return m_nombrePrefixes.complete(prefix, limit);
+    case Component::Field::Tipo:
+        return m_tipoPrefixes.complete(prefix, limit);
+    case Component::Field::Ubicacion:
+        return m_ubicacionPrefixes.complete(prefix, limit);
+    default:
+        return QStringList();
+    }
+}
+
+/**
+ * @brief Convierte una fecha en día juliano de 32 bits.
+ * @param fecha Fecha a convertir.
+ * @return Día juliano, o NoDate si la fecha no es válida.
+ */
+qint32 InventoryCache::toDay(const QDate& fecha)
+{
+    return fecha.isValid() ? qint32(fecha.toJulianDay()) : NoDate;
+}
+
+/**
+ * @brief Une las listas de IDs de los códigos aceptados por @p matches.
+ * @param index Índice de código a IDs.
+ * @param matches Vector indexado por código.
+ * @return Filas coincidentes en orden de ID.
+ */
+QVector<int> InventoryCache::rowsWithCodes(const CodeIndex& index, const QVector<bool>& matches) const
+{
+    QVector<int> ids;
+    int lists = 0;
+    for (auto it = index.cbegin(); it != index.cend(); ++it) {
+        if (it.key() < matches.size() && matches.at(it.key())) {
+            ids += it.value();
+            ++lists;
+        }
+    }
+
+    // Cada lista ya está ordenada; solo hace falta ordenar si se unió más de una.
+    if (lists > 1)
+        std::sort(ids.begin(), ids.end());
+    return rowsOfIds(ids);
+}
+
+/**
+ * @brief Recorre el tramo [min, max] del índice ordenado, o la columna si el tramo es grande.
+ *
+ * El índice devuelve los IDs ordenados por valor, así que hay que ordenarlos y buscar
+ * cada fila; pasado un dieciseisavo del inventario compensa más el recorrido secuencial.
+ *
+ * @param index Índice (valor, ID).
+ * @param column Columna del campo.
+ * @param min Valor mínimo incluido.
+ * @param max Valor máximo incluido.
+ * @return Filas en orden de ID.
+ */
+QVector<int> InventoryCache::rowsInRange(const OrderedIndex<qint32>& index, const QVector<qint32>& column,
+                                         qint32 min, qint32 max) const
+{
+    QVector<int> ids;
+    if (min > max)
+        return ids;
+
+    const int limit = std::max(64, size() / 16);
+    const auto end = index.upper_bound({max, std::numeric_limits<int>::max()});
+    for (auto it = index.lower_bound({min, std::numeric_limits<int>::min()}); it != end; ++it) {
+        if (ids.size() >= limit)
+            return scanRange(column, min, max);
+        ids.append(it->second);
+    }
+
+    std::sort(ids.begin(), ids.end());
+    return rowsOfIds(ids);
+}
+
+/**
+ * @brief Filtra una columna completa en un mapa de selección y devuelve sus filas marcadas.
+ * @param column Columna de enteros.
+ * @param min Valor mínimo incluido.
+ * @param max Valor máximo incluido.
+ * @return Filas en orden creciente.
+ */
+QVector<int> InventoryCache::scanRange(const QVector<qint32>& column, qint32 min, qint32 max)
+{
+    QVector<quint64> bitmap(ScanKernels::bitmapWords(column.size()));
+    quint64* words = bitmap.data();
+    const qint32* values = column.constData();
+
+    // Tramos múltiplos de 64 filas: cada hilo escribe sus propias palabras del mapa.
+    QVector<Chunk> chunks = makeChunks(column.size(), 64);
+    runChunks(chunks, [values, words, min, max](Chunk& chunk) {
+        ScanKernels::selectBetween(values + chunk.begin, chunk.end - chunk.begin,
+                                   min, max, words + chunk.begin / 64);
+    });
+    return ScanKernels::selectedRows(bitmap.constData(), bitmap.size());
+}
+
+//=======================================================================
+// Diccionario
+//=======================================================================
+
+/**
+ * @brief Devuelve el código de un valor, creándolo la primera vez que aparece.
+ * @param value Valor de texto.
+ * @return Código entero.
+ */
+int InventoryCache::Dictionary::intern(const QString& value)
+{
+    auto it = codes.constFind(value);
+    if (it != codes.constEnd())
+        return it.value();
+
+    const int code = values.size();
+    values.append(value);
+    keys.append(SearchKey::normalize(value));
+    codes.insert(value, code);
+    return code;
+}
+
+/**
+ * @brief Marca los códigos cuyo valor cumple la comparación de texto.
+ *
+ * La comparación se hace una vez por valor distinto, con sus claves normalizadas; después
+ * las filas se filtran por código.
+ *
+ * @param op Operador de texto.
+ * @param text Valor de la comparación.
+ * @return Vector indexado por código.
+ */
+QVector<bool> InventoryCache::Dictionary::matching(SearchQuery::Op op, const QString& text) const
+{
+    const QString value = SearchKey::normalize(text);
+    QVector<bool> result(values.size(), false);
+    for (int code = 0; code < values.size(); ++code)
+        result[code] = textMatches(keys.at(code), op, value);
+    return result;
+}
@@ -0,0 +1,472 @@
+#ifndef INVENTORYCACHE_H
+#define INVENTORYCACHE_H
+
+#include <QVector>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+#include <optional>
+#include <limits>
+#include <set>
+#include <utility>
+#include <functional>
+#include "component.h"
+#include "fuzzymatcher.h"
+#include "prefixindex.h"
+#include "searchquery.h"
+#include "trigramindex.h"
+
+/// @file inventorycache.h
+/// @brief Declaración de la clase InventoryCache, copia en memoria del inventario organizada por columnas.
+
+/**
+ * @class InventoryCache
+ * @brief Copia en memoria del inventario con un arreglo contiguo por campo (estructura de arreglos).
+ *
+ * Cada componente ocupa la misma posición (fila) en todos los arreglos, y las filas se
+ * mantienen ordenadas por ID, de modo que localizar un ID es una búsqueda binaria. Tipo y
+ * ubicación se guardan como códigos enteros de un diccionario por campo, y la fecha como
+ * día juliano. Los nombres y los valores de los diccionarios guardan además su clave
+ * normalizada (SearchKey), calculada al escribir: las búsquedas de texto no distinguen
+ * mayúsculas ni acentos y solo normalizan el valor buscado, una vez por consulta. Así los filtros recorren memoria contigua y comparan enteros en lugar de
+ * reconstruir objetos Component.
+ *
+ * Los rangos amplios de cantidad y fecha se resuelven recorriendo la columna con
+ * instrucciones SIMD (ScanKernels) en lugar del índice.
+ *
+ * Además mantiene índices secundarios por ID (estables aunque las filas se desplacen):
+ * tipo y ubicación tienen un hash de código a lista ordenada de IDs, y cantidad y fecha un
+ * índice ordenado (valor, ID); los nombres, un índice de trigramas (TrigramIndex). Nombre,
+ * tipo y ubicación tienen también un PrefixIndex para autocompletar. Los
+ * filtros por igualdad, rango o subcadena consultan el índice y solo visitan las filas que
+ * coinciden, en lugar de recorrer todo el inventario.
+ *
+ * InventoryManager la carga una vez desde la base de datos y la actualiza en cada alta,
+ * modificación o baja (escritura directa); cada cambio actualiza también los índices.
+ *
+ * En inventarios grandes, los recorridos completos (nombres, rangos amplios, verificación
+ * de candidatos y reconstrucción de componentes) se reparten por tramos entre los hilos
+ * del QThreadPool global y se unen en orden de fila. Las llamadas siguen siendo síncronas:
+ * no deben ejecutarse a la vez que una escritura.
+ */
+class InventoryCache {
+public:
+    /// Valor de fecha usado para los componentes sin fecha de adquisición.
+    static constexpr qint32 NoDate = std::numeric_limits<qint32>::min();
+
+    /**
+     * @struct FuzzyHit
+     * @brief Fila encontrada por la búsqueda aproximada.
+     */
+    struct FuzzyHit {
+        int row = 0;      ///< Fila del componente.
+        int distance = 0; ///< Distancia de edición del patrón al nombre.
+    };
+
+    /**
+     * @brief Vacía la caché y la marca como no cargada.
+     */
+    void clear();
+
+    /**
+     * @brief Indica si la caché refleja el contenido de la base de datos.
+     * @return true tras markLoaded(), false tras clear().
+     */
+    bool isLoaded() const;
+
+    /**
+     * @brief Marca la caché como cargada por completo.
+     */
+    void markLoaded();
+
+    /**
+     * @brief Número de componentes almacenados.
+     * @return Cantidad de filas.
+     */
+    int size() const;
+
+    /**
+     * @brief Agrega un componente ya persistido (con ID asignado).
+     *
+     * Si el ID es mayor que el último, la fila se añade al final; si no, se inserta en su
+     * posición para conservar el orden. Un ID ya presente se actualiza.
+     *
+     * @param comp Componente a agregar.
+     */
+    void insert(const Component& comp);
+
+    /**
+     * @brief Reemplaza los datos del componente con el mismo ID.
+     * @param comp Componente con los datos nuevos.
+     * @return true si el ID existía.
+     */
+    bool update(const Component& comp);
+
+    /**
+     * @brief Elimina el componente con el ID indicado.
+     * @param id ID del componente.
+     * @return true si el ID existía.
+     */
+    bool remove(int id);
+
+    /**
+     * @brief Posición (fila) de un ID en los arreglos.
+     * @param id ID del componente.
+     * @return Fila, o -1 si no está en la caché.
+     */
+    int rowOf(int id) const;
+
+    /**
+     * @brief Reconstruye el componente almacenado en una fila.
+     * @param row Fila válida.
+     * @return Componente de esa fila.
+     */
+    Component componentAt(int row) const;
+
+    /**
+     * @brief Busca un componente por ID.
+     * @param id ID del componente.
+     * @return El componente, o std::nullopt si no existe.
+     */
+    std::optional<Component> component(int id) const;
+
+    /**
+     * @brief Reconstruye todos los componentes, en orden de ID.
+     * @return Lista de componentes.
+     */
+    QList<Component> components() const;
+
+    /**
+     * @brief Reconstruye los componentes de las filas indicadas, en el orden dado.
+     * @param rows Filas válidas.
+     * @return Lista de componentes.
+     */
+    QList<Component> components(const QVector<int>& rows) const;
+
+    /**
+     * @brief Filas cuyo nombre contiene @p keyword, sin distinguir mayúsculas ni acentos.
+     *
+     * Con tres caracteres o más, solo se comprueban los candidatos del índice de trigramas;
+     * con menos se recorren todos los nombres.
+     *
+     * @param keyword Texto a buscar.
+     * @return Filas coincidentes en orden de ID.
+     */
+    QVector<int> rowsWhereNombreContains(const QString& keyword) const;
+
+    /**
+     * @brief Filas cuyo nombre contiene el patrón con como mucho @p maxErrors errores de
+     * edición, de la más a la menos parecida.
+     *
+     * El índice de trigramas descarta primero los nombres que no comparten suficientes
+     * trigramas con el patrón; solo los candidatos se comparan con FuzzyMatcher, repartidos
+     * entre los hilos del grupo global. Si el patrón es demasiado corto para filtrar, se
+     * comparan todos los nombres.
+     *
+     * @param matcher Patrón preparado.
+     * @param maxErrors Errores tolerados.
+     * @param limit Número máximo de resultados.
+     * @return Resultados ordenados por distancia, después por diferencia de longitud con el
+     *         patrón y por último por ID.
+     */
+    QVector<FuzzyHit> rowsWhereNombreNear(const FuzzyMatcher& matcher, int maxErrors, int limit) const;
+
+    /**
+     * @brief Filas cuyo tipo contiene @p keyword, sin distinguir mayúsculas ni acentos.
+     *
+     * El texto se compara una vez por valor distinto del diccionario; las filas se filtran
+     * después comparando códigos enteros.
+     *
+     * @param keyword Texto a buscar.
+     * @return Filas coincidentes en orden de ID.
+     */
+    QVector<int> rowsWhereTipoContains(const QString& keyword) const;
+
+    /**
+     * @brief Filas cuya ubicación contiene @p keyword, sin distinguir mayúsculas ni acentos.
+     * @param keyword Texto a buscar.
+     * @return Filas coincidentes en orden de ID.
+     */
+    QVector<int> rowsWhereUbicacionContains(const QString& keyword) const;
+
+    /**
+     * @brief Filas cuyo tipo es exactamente @p tipo.
+     *
+     * El texto se traduce una sola vez a su código; si no está en el diccionario no hay
+     * ninguna fila que recorrer.
+     *
+     * @param tipo Tipo a buscar.
+     * @return Filas coincidentes en orden de ID.
+     */
+    QVector<int> rowsWhereTipoIs(const QString& tipo) const;
+
+    /**
+     * @brief Filas cuya ubicación es exactamente @p ubicacion.
+     * @param ubicacion Ubicación a buscar.
+     * @return Filas coincidentes en orden de ID.
+     */
+    QVector<int> rowsWhereUbicacionIs(const QString& ubicacion) const;
+
+    /**
+     * @brief Filas cuya cantidad está entre @p min y @p max (ambos incluidos).
+     * @param min Cantidad mínima.
+     * @param max Cantidad máxima.
+     * @return Filas coincidentes en orden de ID.
+     */
+    QVector<int> rowsWhereCantidadBetween(int min, int max) const;
+
+    /**
+     * @brief Filas cuya fecha (día juliano) está entre @p from y @p to (ambos incluidos).
+     * @param from Primer día incluido.
+     * @param to Último día incluido.
+     * @return Filas coincidentes en orden de ID; nunca incluye componentes sin fecha.
+     */
+    QVector<int> rowsWhereFechaBetween(qint32 from, qint32 to) const;
+
+    /**
+     * @brief Filas de los @p k componentes con menos cantidad.
+     *
+     * El índice ordenado (cantidad, ID) ya tiene los componentes en ese orden, así que basta
+     * con recorrer sus @p k primeras entradas: O(k log n), sin ordenar el inventario.
+     *
+     * @param k Número de filas.
+     * @return Filas de menor a mayor cantidad (a igual cantidad, por ID).
+     */
+    QVector<int> rowsWithLowestCantidad(int k) const;
+
+    /**
+     * @brief Filas de las @p k adquisiciones más recientes, recorriendo el índice de fechas
+     * desde el final.
+     * @param k Número de filas.
+     * @return Filas de la fecha más reciente a la más antigua (a igual fecha, el ID mayor
+     *         primero); no incluye componentes sin fecha.
+     */
+    QVector<int> rowsWithLatestFecha(int k) const;
+
+    /**
+     * @brief Filas que cumplen una consulta de varios criterios.
+     *
+     * La consulta se compila en un plan: en cada nodo AND, la condición más selectiva
+     * (según el tamaño estimado a partir de los índices) se resuelve con su índice y las
+     * demás se convierten en predicados especializados sobre las columnas, que se aplican
+     * solo a esas filas, de la más a la menos selectiva. Los nodos OR unen los resultados
+     * de sus partes.
+     *
+     * @param query Consulta válida.
+     * @return Filas coincidentes en orden de ID; vacía si la consulta no es válida.
+     */
+    QVector<int> rowsWhere(const SearchQuery& query) const;
+
+    /**
+     * @brief Ordena filas cuyo nombre contiene @p keyword de la más a la menos relevante.
+     *
+     * Reproduce el bm25 del índice FTS5 de DatabaseManager para una frase sobre la columna
+     * nombre: frecuencia de la frase en la clave del nombre y longitud de la fila en
+     * trigramas (nombre, tipo y ubicación), con k1 = 1.2 y b = 0.75. La IDF es la misma para
+     * todas las filas y no cambia el orden, así que ambos caminos devuelven el mismo orden.
+     *
+     * @param rows Filas coincidentes; se reordenan en el sitio (a igual relevancia, por ID).
+     * @param keyword Subcadena buscada.
+     */
+    void rankByNombreRelevance(QVector<int>& rows, const QString& keyword) const;
+
+    /**
+     * @brief Valores más usados de un campo de texto que empiezan por @p prefix.
+     * @param field Nombre, Tipo o Ubicacion.
+     * @param prefix Texto escrito hasta ahora (sin distinguir mayúsculas).
+     * @param limit Número máximo de sugerencias.
+     * @return Sugerencias de la más a la menos usada; vacía para otros campos.
+     */
+    QStringList completions(Component::Field field, const QString& prefix, int limit);
+
+    /**
+     * @brief Convierte una fecha a su representación en la caché.
+     * @param fecha Fecha a convertir.
+     * @return Día juliano, o NoDate si la fecha no es válida.
+     */
+    static qint32 toDay(const QDate& fecha);
+
+    // Acceso de solo lectura a las columnas (todas con size() elementos).
+    const QVector<int>& ids() const { return m_ids; }                ///< IDs en orden creciente.
+    const QVector<int>& cantidades() const { return m_cantidades; }  ///< Cantidades.
+    const QVector<qint32>& fechas() const { return m_fechas; }      ///< Días julianos o NoDate.
+    const QVector<int>& tipoCodes() const { return m_tipos; }        ///< Códigos del diccionario de tipos.
+    const QVector<int>& ubicacionCodes() const { return m_ubicaciones; } ///< Códigos del diccionario de ubicaciones.
+    const QVector<QString>& nombres() const { return m_nombres; }    ///< Nombres.
+
+private:
+    /**
+     * @struct Dictionary
+     * @brief Diccionario de valores de texto de un campo: cada valor distinto recibe un código.
+     */
+    struct Dictionary {
+        QStringList values;           ///< Valor de cada código.
+        QStringList keys;             ///< Clave normalizada (SearchKey) de cada código.
+        QHash<QString, int> codes;    ///< Código de cada valor.
+
+        /**
+         * @brief Devuelve el código de un valor, agregándolo si no existe.
+         * @param value Valor de texto.
+         * @return Código del valor.
+         */
+        int intern(const QString& value);
+
+        /**
+         * @brief Códigos cuyos valores cumplen una comparación de texto.
+         * @param op Equals, Contains o Prefix (sin distinguir mayúsculas ni acentos).
+         * @param text Texto de la comparación.
+         * @return Vector indexado por código: true si el valor coincide.
+         */
+        QVector<bool> matching(SearchQuery::Op op, const QString& text) const;
+    };
+
+    /// Predicado compilado sobre una fila.
+    using RowPredicate = std::function<bool(int)>;
+
+    /// Índice de igualdad: código de diccionario -> IDs en orden creciente.
+    using CodeIndex = QHash<int, QVector<int>>;
+
+    /// Índice ordenado por (valor, ID).
+    template <typename T>
+    using OrderedIndex = std::set<std::pair<T, int>>;
+
+    /**
+     * @brief Filas de una lista de IDs ordenada de menor a mayor.
+     * @param ids IDs presentes en la caché, sin repetir.
+     * @return Filas en el mismo orden.
+     */
+    QVector<int> rowsOfIds(const QVector<int>& ids) const;
+
+    /**
+     * @brief Filas de los componentes cuyo código está marcado en @p matches.
+     * @param index Índice del campo.
+     * @param matches Códigos aceptados.
+     * @return Filas en orden de ID.
+     */
+    QVector<int> rowsWithCodes(const CodeIndex& index, const QVector<bool>& matches) const;
+
+    /**
+     * @brief Filas cuyo valor está entre @p min y @p max.
+     *
+     * Si el rango es selectivo se recorre el índice ordenado; si abarca una parte grande
+     * del inventario (por ejemplo, un umbral de stock alto), se recorre la columna completa
+     * con scanRange(), que resulta más barato que ordenar muchos IDs.
+     *
+     * @param index Índice ordenado del campo.
+     * @param column Columna del mismo campo.
+     * @param min Valor mínimo incluido.
+     * @param max Valor máximo incluido.
+     * @return Filas en orden de ID.
+     */
+    QVector<int> rowsInRange(const OrderedIndex<qint32>& index, const QVector<qint32>& column,
+                             qint32 min, qint32 max) const;
+
+    /**
+     * @brief Recorre una columna con los filtros vectorizados de ScanKernels.
+     * @param column Columna de enteros.
+     * @param min Valor mínimo incluido.
+     * @param max Valor máximo incluido.
+     * @return Filas en orden creciente.
+     */
+    static QVector<int> scanRange(const QVector<qint32>& column, qint32 min, qint32 max);
+
+    /**
+     * @brief Filas cuyo nombre cumple una comparación de texto, con los candidatos del
+     * índice de trigramas cuando el valor tiene al menos tres caracteres.
+     * @param op Equals, Contains o Prefix.
+     * @param text Texto de la comparación.
+     * @return Filas en orden de ID.
+     */
+    QVector<int> rowsWhereNombre(SearchQuery::Op op, const QString& text) const;
+
+    /**
+     * @brief Filas que cumplen una condición, usando el índice de su campo.
+     * @param condition Condición válida.
+     * @return Filas en orden de ID.
+     */
+    QVector<int> rowsWhere(const SearchQuery::Condition& condition) const;
+
+    /**
+     * @brief Número aproximado de filas que devolvería una consulta, según los índices.
+     * @param query Consulta.
+     * @return Estimación, como máximo size().
+     */
+    qint64 estimateRows(const SearchQuery& query) const;
+
+    /**
+     * @brief Convierte una consulta en un predicado sobre filas, con los valores ya
+     * convertidos y las partes de AND ordenadas por selectividad.
+     * @param query Consulta válida.
+     * @return Predicado.
+     */
+    RowPredicate compile(const SearchQuery& query) const;
+
+    /**
+     * @brief Intervalo cerrado de valores enteros (ID, cantidad o día juliano) de una condición.
+     * @param condition Condición sobre Id, Cantidad o FechaAdquisicion.
+     * @param min Recibe el límite inferior.
+     * @param max Recibe el límite superior.
+     */
+    static void integerBounds(const SearchQuery::Condition& condition, qint64& min, qint64& max);
+
+    /**
+     * @brief Compara dos claves normalizadas (SearchKey) según un operador de texto.
+     * @param key Clave almacenada.
+     * @param op Equals, Contains o Prefix.
+     * @param value Clave del valor de la condición.
+     * @return true si coincide.
+     */
+    static bool textMatches(const QString& key, SearchQuery::Op op, const QString& value);
+
+    /**
+     * @brief Agrega una fila a los índices secundarios.
+     * @param row Fila ya asignada.
+     */
+    void indexRow(int row);
+
+    /**
+     * @brief Quita una fila de los índices secundarios (antes de modificarla o eliminarla).
+     * @param row Fila indexada.
+     */
+    void unindexRow(int row);
+
+    /**
+     * @brief Escribe los datos de un componente en una fila existente.
+     * @param row Fila a sobrescribir.
+     * @param comp Datos del componente.
+     */
+    void assign(int row, const Component& comp);
+
+    /**
+     * @brief Longitud de una fila en trigramas, como la cuenta el índice FTS5.
+     * @param row Fila.
+     * @return Trigramas de las claves de nombre, tipo y ubicación.
+     */
+    int rowTokens(int row) const;
+
+    QVector<int> m_ids;          ///< IDs, ordenados de menor a mayor.
+    QVector<int> m_cantidades;   ///< Cantidad disponible por fila.
+    QVector<qint32> m_fechas;    ///< Fecha de adquisición como día juliano por fila.
+    QVector<int> m_tipos;        ///< Código de tipo por fila.
+    QVector<int> m_ubicaciones;  ///< Código de ubicación por fila.
+    QVector<QString> m_nombres;  ///< Nombre por fila.
+    QVector<QString> m_nombreClaves; ///< Clave normalizada del nombre por fila (SearchKey).
+    qint64 m_tokenTotal = 0;     ///< Suma de rowTokens() de todas las filas (para bm25).
+
+    Dictionary m_tipoDict;       ///< Diccionario de tipos.
+    Dictionary m_ubicacionDict;  ///< Diccionario de ubicaciones.
+
+    CodeIndex m_idsByTipo;                 ///< Código de tipo -> IDs.
+    CodeIndex m_idsByUbicacion;            ///< Código de ubicación -> IDs.
+    OrderedIndex<int> m_byCantidad;        ///< (cantidad, ID) en orden.
+    OrderedIndex<qint32> m_byFecha;        ///< (día juliano, ID) en orden; excluye NoDate.
+    TrigramIndex m_nombreTrigrams;         ///< Trigramas de los nombres -> IDs.
+    PrefixIndex m_nombrePrefixes;          ///< Nombres distintos para autocompletar.
+    PrefixIndex m_tipoPrefixes;            ///< Tipos distintos para autocompletar.
+    PrefixIndex m_ubicacionPrefixes;       ///< Ubicaciones distintas para autocompletar.
+
+    bool m_loaded = false;       ///< Indica si la caché está completa.
+};
+
+#endif // INVENTORYCACHE_H
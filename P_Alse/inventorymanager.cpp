@@ -1,13 +1,32 @@
 #include "inventorymanager.h"
+#include "fuzzymatcher.h"
+#include "searchkey.h"
+#include <QDateTime>
+#include <QTime>
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <vector>
 
 /**
  * @class InventoryManager
  * @brief Clase que maneja la lógica de inventario utilizando una base de datos.
  */
-InventoryManager::InventoryManager()
+InventoryManager::InventoryManager(const QString& databasePath, LoadMode mode)
+    : m_mode(mode), m_results(mode == LoadMode::Full ? ResultCacheCapacity : 0)
 {
-    m_dbManager = new DatabaseManager("inventory.db");
-    m_dbManager->openDatabase();
+    m_dbManager = new DatabaseManager(databasePath);
+    if (m_dbManager->openDatabase()) {
+        reloadCache();
+        m_dataVersion = m_dbManager->dataVersion();
+    }
+
+    m_dayTimer.setSingleShot(true);
+    QObject::connect(&m_dayTimer, &QTimer::timeout, [this] {
+        refreshAgeing();
+        scheduleDayBoundary();
+    });
+    scheduleDayBoundary();
 }
 
 /**
@@ -20,6 +39,15 @@ InventoryManager::~InventoryManager()
     delete m_dbManager;
 }
 
+/**
+ * @brief Comprueba si la última carga terminó bien.
+ * @return true si el inventario está listo.
+ */
+bool InventoryManager::isLoaded() const
+{
+    return m_loaded;
+}
+
 /**
  * @brief Agrega un componente a la base de datos.
  * @param comp El componente a agregar.
@@ -27,46 +55,355 @@ InventoryManager::~InventoryManager()
  */
 bool InventoryManager::addComponent(const Component& comp)
 {
-    return m_dbManager->addComponent(comp);
+    int id = -1;
+    if (!m_dbManager->addComponent(comp, &id))
+        return false;
+    invalidateResults();
+
+    Component stored = comp;
+    stored.setId(id);
+    if (m_cache.isLoaded())
+        m_cache.insert(stored);
+    m_alerts.evaluate(stored);
+    return true;
+}
+
+/**
+ * @brief Agrega una lista de componentes usando la inserción en bloque de la base de datos.
+ * @param comps Componentes a agregar.
+ * @return IDs asignados en el mismo orden; -1 en los que fallaron.
+ */
+QList<int> InventoryManager::addComponents(const QList<Component>& comps)
+{
+    const QList<int> ids = m_dbManager->addComponents(comps);
+    if (std::any_of(ids.cbegin(), ids.cend(), [](int id) { return id >= 0; }))
+        invalidateResults();
+
+    for (int i = 0; i < ids.size(); ++i) {
+        if (ids.at(i) < 0)
+            continue;
+        Component stored = comps.at(i);
+        stored.setId(ids.at(i));
+        if (m_cache.isLoaded())
+            m_cache.insert(stored);
+        m_alerts.evaluate(stored);
+    }
+    return ids;
 }
 
 /**
  * @brief Recupera todos los componentes del inventario.
+ *
+ * Como las búsquedas, los lectores comprueban antes si otro proceso cambió la base de datos
+ * (reloadIfChanged()) para no servir una caché desactualizada.
+ *
  * @return Una lista de todos los componentes.
  */
 QList<Component> InventoryManager::getAllComponents()
 {
+    reloadIfChanged();
+    if (m_cache.isLoaded())
+        return m_cache.components();
     return m_dbManager->getAllComponents();
 }
 
+/**
+ * @brief Recorre todos los componentes del inventario en memoria constante.
+ * @param visitor Función que recibe cada componente; devuelve false para detenerse.
+ * @return true si el recorrido se realizó correctamente.
+ */
+bool InventoryManager::forEachComponent(const ComponentVisitor& visitor)
+{
+    reloadIfChanged();
+    if (!m_cache.isLoaded())
+        return m_dbManager->forEachComponent(visitor);
+
+    for (int row = 0; row < m_cache.size(); ++row) {
+        if (!visitor(m_cache.componentAt(row)))
+            break;
+    }
+    return true;
+}
+
+/**
+ * @brief Obtiene un componente por su clave primaria.
+ * @param id ID del componente.
+ * @return El componente, o std::nullopt si no existe.
+ */
+std::optional<Component> InventoryManager::getComponentById(int id)
+{
+    reloadIfChanged();
+    if (m_cache.isLoaded())
+        return m_cache.component(id);
+    return m_dbManager->getComponentById(id);
+}
+
+/**
+ * @brief Obtiene varios componentes por sus IDs.
+ * @param ids IDs a buscar.
+ * @return Componentes encontrados, ordenados por ID.
+ */
+QList<Component> InventoryManager::getComponentsByIds(const QList<int>& ids)
+{
+    reloadIfChanged();
+    if (!m_cache.isLoaded())
+        return m_dbManager->getComponentsByIds(ids);
+
+    QVector<int> rows;
+    rows.reserve(ids.size());
+    for (int id : ids) {
+        const int row = m_cache.rowOf(id);
+        if (row >= 0)
+            rows.append(row);
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    return m_cache.components(rows);
+}
+
+/**
+ * @brief Recupera una página del inventario sin cargar la tabla completa.
+ * @param afterKey Clave de continuación de la página anterior.
+ * @param limit Tamaño máximo de la página.
+ * @param sortColumn Campo de orden.
+ * @return Página de componentes.
+ */
+ComponentPage InventoryManager::getComponentsPage(const PageKey& afterKey, int limit,
+                                                  Component::Field sortColumn)
+{
+    return m_dbManager->getComponentsPage(afterKey, limit, sortColumn);
+}
+
 /**
  * @brief Busca componentes en base a una palabra clave y un criterio.
+ *
+ * El criterio se traduce a una SearchQuery de una condición y se ejecuta con search().
+ *
  * @param keyword La palabra clave para buscar.
  * @param criteria El criterio por el cual se va a buscar (Nombre, Tipo, Cantidad, Ubicación, Fecha).
  * @return Una lista de componentes que coinciden con la búsqueda.
  */
 QList<Component> InventoryManager::searchComponents(const QString& keyword, const QString& criteria)
 {
-    QList<Component> results;
-    QList<Component> allComponents = getAllComponents();
-
-    for (const Component& comp : allComponents) {
-        if (criteria == "Nombre" && comp.getNombre().contains(keyword, Qt::CaseInsensitive)) {
-            results.append(comp);
-        } else if (criteria == "Tipo" && comp.getTipo().contains(keyword, Qt::CaseInsensitive)) {
-            results.append(comp);
-        } else if (criteria == "Cantidad" && QString::number(comp.getCantidad()) == keyword) {
-            results.append(comp);
-        } else if (criteria == "Ubicación" && comp.getUbicacion().contains(keyword, Qt::CaseInsensitive)) {
-            results.append(comp);
-        } else if (criteria == "Fecha" && comp.getFechaAdquisicion().toString("yyyy-MM-dd") == keyword) {
-            results.append(comp);
+    return search(SearchQuery::fromCriteria(keyword, criteria));
+}
+
+/**
+ * @brief Busca componentes que cumplen una consulta de varios criterios.
+ *
+ * Con la caché cargada, la consulta se compila en un plan sobre sus índices (ver
+ * InventoryCache::rowsWhere()); si no, se traduce a SQL. Una búsqueda por nombre se ordena
+ * por relevancia en los dos caminos (InventoryCache::rankByNombreRelevance() reproduce el
+ * bm25 de FTS5).
+ *
+ * @param query Consulta a ejecutar.
+ * @return Componentes coincidentes, ordenados por ID o por relevancia; vacía si la consulta
+ *         no es válida.
+ */
+QList<Component> InventoryManager::search(const SearchQuery& query)
+{
+    if (!query.isValid())
+        return QList<Component>();
+    return cachedResult("query:" + query.key(), [this, &query] {
+        if (m_cache.isLoaded()) {
+            QVector<int> rows = m_cache.rowsWhere(query);
+            if (query.isRankedByRelevance())
+                m_cache.rankByNombreRelevance(rows, query.condition().value.toString());
+            return m_cache.components(rows);
         }
+        return m_dbManager->searchComponents(query);
+    });
+}
+
+/**
+ * @brief Búsqueda aproximada por nombre.
+ *
+ * Con la caché cargada se usa su índice de trigramas como filtro previo; si no, se
+ * recorre la base de datos comparando cada nombre.
+ *
+ * @param text Texto buscado.
+ * @param limit Número máximo de resultados.
+ * @return Componentes ordenados por parecido.
+ */
+QList<Component> InventoryManager::fuzzySearch(const QString& text, int limit)
+{
+    const FuzzyMatcher matcher(text.trimmed());
+    if (matcher.pattern().isEmpty())
+        return QList<Component>();
+
+    return cachedResult(QString("fuzzy:%1:%2").arg(limit).arg(matcher.pattern()), [this, &matcher, limit] {
+        return fuzzySearchUncached(matcher, limit);
+    });
+}
+
+/**
+ * @brief Ejecuta la búsqueda aproximada sin consultar la caché de resultados.
+ * @param matcher Patrón preparado.
+ * @param limit Número máximo de resultados.
+ * @return Componentes ordenados por parecido.
+ */
+QList<Component> InventoryManager::fuzzySearchUncached(const FuzzyMatcher& matcher, int limit)
+{
+    const int maxErrors = matcher.defaultMaxErrors();
+    if (m_cache.isLoaded()) {
+        QVector<int> rows;
+        for (const InventoryCache::FuzzyHit& hit : m_cache.rowsWhereNombreNear(matcher, maxErrors, limit))
+            rows.append(hit.row);
+        return m_cache.components(rows);
     }
 
+    struct Hit {
+        int distance;
+        int extra;
+        Component comp;
+    };
+    std::vector<Hit> hits;
+    m_dbManager->forEachComponent([&](const Component& comp) {
+        const QString key = SearchKey::normalize(comp.getNombre());
+        const int distance = matcher.distance(key, maxErrors);
+        if (distance <= maxErrors) {
+            const int extra = std::abs(int(key.size() - matcher.pattern().size()));
+            hits.push_back(Hit{distance, extra, comp});
+        }
+        return true;
+    });
+
+    std::stable_sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) {
+        return a.distance != b.distance ? a.distance < b.distance : a.extra < b.extra;
+    });
+    QList<Component> results;
+    for (int i = 0; i < int(hits.size()) && i < limit; ++i)
+        results.append(hits[i].comp);
     return results;
 }
 
+/**
+ * @brief Sugerencias de autocompletado.
+ *
+ * Con la caché cargada se consultan sus índices de prefijos; si no, se buscan en la base
+ * de datos los componentes con ese prefijo y se cuentan sus valores.
+ *
+ * @param field Campo de texto.
+ * @param prefix Texto escrito.
+ * @param limit Número máximo de sugerencias.
+ * @return Sugerencias ordenadas por frecuencia.
+ */
+QStringList InventoryManager::completions(Component::Field field, const QString& prefix, int limit)
+{
+    if (m_cache.isLoaded())
+        return m_cache.completions(field, prefix, limit);
+
+    const SearchQuery query = SearchQuery::where(field, SearchQuery::Op::Prefix, prefix);
+    if (prefix.isEmpty() || !query.isValid())
+        return QStringList();
+
+    PrefixIndex values;
+    for (const Component& comp : m_dbManager->searchComponents(query)) {
+        values.insert(field == Component::Field::Nombre ? comp.getNombre()
+                      : field == Component::Field::Tipo ? comp.getTipo()
+                                                        : comp.getUbicacion());
+    }
+    return values.complete(prefix, limit);
+}
+
+/**
+ * @brief Busca componentes por rango de fechas de adquisición.
+ * @param from Fecha inicial incluida (inválida para un rango abierto).
+ * @param to Fecha final incluida (inválida para un rango abierto).
+ * @return Lista de componentes dentro del rango.
+ */
+QList<Component> InventoryManager::searchByDateRange(const QDate& from, const QDate& to)
+{
+    const QString key = QString("fecha:%1..%2").arg(from.toString(Qt::ISODate), to.toString(Qt::ISODate));
+    return cachedResult(key, [this, &from, &to] {
+        if (!m_cache.isLoaded())
+            return m_dbManager->searchByDateRange(from, to);
+
+        const qint32 first = from.isValid() ? InventoryCache::toDay(from) : InventoryCache::NoDate;
+        const qint32 last = to.isValid() ? InventoryCache::toDay(to) : std::numeric_limits<qint32>::max();
+        return m_cache.components(m_cache.rowsWhereFechaBetween(first, last));
+    });
+}
+
+/**
+ * @brief Busca componentes por rango de cantidad.
+ *
+ * Con la caché cargada se resuelve con su índice ordenado de cantidades, sin recorrer el
+ * resto del inventario.
+ *
+ * @param min Cantidad mínima incluida.
+ * @param max Cantidad máxima incluida.
+ * @return Lista de componentes dentro del rango.
+ */
+QList<Component> InventoryManager::searchByQuantityRange(int min, int max)
+{
+    return cachedResult(QString("cantidad:%1..%2").arg(min).arg(max), [this, min, max] {
+        if (m_cache.isLoaded())
+            return m_cache.components(m_cache.rowsWhereCantidadBetween(min, max));
+        return m_dbManager->searchByQuantityRange(min, max);
+    });
+}
+
+/**
+ * @brief Busca componentes cuyo tipo coincide exactamente.
+ *
+ * Tanto la caché como la base de datos traducen el texto a su código de diccionario y
+ * comparan enteros.
+ *
+ * @param tipo Tipo a buscar.
+ * @return Lista de componentes de ese tipo.
+ */
+QList<Component> InventoryManager::searchByTipo(const QString& tipo)
+{
+    return cachedResult("tipo:" + tipo, [this, &tipo] {
+        if (m_cache.isLoaded())
+            return m_cache.components(m_cache.rowsWhereTipoIs(tipo));
+        return m_dbManager->searchByTipo(tipo);
+    });
+}
+
+/**
+ * @brief Busca componentes cuya ubicación coincide exactamente.
+ * @param ubicacion Ubicación a buscar.
+ * @return Lista de componentes en esa ubicación.
+ */
+QList<Component> InventoryManager::searchByUbicacion(const QString& ubicacion)
+{
+    return cachedResult("ubicacion:" + ubicacion, [this, &ubicacion] {
+        if (m_cache.isLoaded())
+            return m_cache.components(m_cache.rowsWhereUbicacionIs(ubicacion));
+        return m_dbManager->searchByUbicacion(ubicacion);
+    });
+}
+
+/**
+ * @brief Top-k por cantidad: índice ordenado de la caché o ORDER BY ... LIMIT en SQL.
+ * @param k Número de componentes.
+ * @return Componentes más críticos.
+ */
+QList<Component> InventoryManager::lowestStock(int k)
+{
+    return cachedResult(QString("menor-stock:%1").arg(k), [this, k] {
+        if (m_cache.isLoaded())
+            return m_cache.components(m_cache.rowsWithLowestCantidad(k));
+        return m_dbManager->lowestStock(k);
+    });
+}
+
+/**
+ * @brief Top-k por fecha de adquisición.
+ * @param k Número de componentes.
+ * @return Adquisiciones más recientes.
+ */
+QList<Component> InventoryManager::mostRecent(int k)
+{
+    return cachedResult(QString("recientes:%1").arg(k), [this, k] {
+        if (m_cache.isLoaded())
+            return m_cache.components(m_cache.rowsWithLatestFecha(k));
+        return m_dbManager->mostRecent(k);
+    });
+}
+
 /**
  * @brief Actualiza un componente existente en la base de datos.
  * @param id El ID del componente a actualizar.
@@ -75,7 +412,16 @@ QList<Component> InventoryManager::searchComponents(const QString& keyword, cons
  */
 bool InventoryManager::updateComponent(int id, const Component& comp)
 {
-    return m_dbManager->updateComponent(id, comp);
+    if (!m_dbManager->updateComponent(id, comp))
+        return false;
+    invalidateResults();
+
+    Component stored = comp;
+    stored.setId(id);
+    if (m_cache.isLoaded())
+        m_cache.update(stored);
+    m_alerts.evaluate(stored);
+    return true;
 }
 
 /**
@@ -85,7 +431,341 @@ bool InventoryManager::updateComponent(int id, const Component& comp)
  */
 bool InventoryManager::deleteComponent(int id)
 {
-    return m_dbManager->deleteComponent(id);
+    if (!m_dbManager->deleteComponent(id))
+        return false;
+    invalidateResults();
+
+    m_cache.remove(id);
+    m_alerts.remove(id);
+    return true;
+}
+
+/**
+ * @brief Vuelve a cargar la caché en memoria desde la base de datos.
+ *
+ * Necesario solo si otro proceso modificó el archivo: los cambios hechos a través de
+ * este InventoryManager ya se aplican a la caché al escribir. Es también el único punto en
+ * que las alertas se evalúan para todo el inventario.
+ *
+ * En LoadMode::AlertsOnly las filas solo pasan por el AlertEngine: la caché queda vacía y
+ * sin marcar como cargada, así que el resto de los métodos consulta la base de datos.
+ *
+ * @return true si la caché (o las alertas) quedó cargada.
+ */
+bool InventoryManager::reloadCache()
+{
+    invalidateResults();
+    m_cache.clear();
+    m_alerts.clear();
+
+    QHash<int, int> componentPoints;
+    QHash<QString, int> tipoPoints;
+    if (m_dbManager->reorderPoints(componentPoints, tipoPoints))
+        m_alerts.setReorderPoints(componentPoints, tipoPoints);
+    m_alerts.setAgeingRules(m_dbManager->ageingRules());
+    m_alerts.setToday(QDate::currentDate());
+
+    const bool full = m_mode == LoadMode::Full;
+    const bool ok = m_dbManager->forEachComponent([this, full](const Component& comp) {
+        if (full)
+            m_cache.insert(comp);
+        m_alerts.evaluate(comp);
+        return true;
+    });
+
+    if (ok && full)
+        m_cache.markLoaded();
+    else
+        m_cache.clear();
+    m_loaded = ok;
+    return ok;
+}
+
+/**
+ * @brief Alertas activas, tras comprobar si otro proceso cambió la base de datos.
+ * @param limit Número máximo de alertas (-1 para todas).
+ * @return Alertas por gravedad.
+ */
+QList<AlertEngine::Alert> InventoryManager::activeAlerts(int limit)
+{
+    reloadIfChanged();
+    return m_alerts.alerts(limit);
+}
+
+/**
+ * @brief Punto de reorden efectivo de un componente.
+ * @param comp Componente.
+ * @return Punto aplicado.
+ */
+int InventoryManager::reorderPoint(const Component& comp) const
+{
+    return m_alerts.reorderPoint(comp);
+}
+
+/**
+ * @brief Punto de reorden propio de un componente.
+ * @param id ID del componente.
+ * @return Punto, o std::nullopt.
+ */
+std::optional<int> InventoryManager::componentReorderPoint(int id) const
+{
+    return m_alerts.componentReorderPoint(id);
+}
+
+/**
+ * @brief Punto de reorden de un tipo.
+ * @param tipo Tipo.
+ * @return Punto, o std::nullopt.
+ */
+std::optional<int> InventoryManager::tipoReorderPoint(const QString& tipo) const
+{
+    return m_alerts.tipoReorderPoint(tipo);
+}
+
+/**
+ * @brief Guarda el punto de un componente y reevalúa solo ese componente.
+ * @param id ID del componente.
+ * @param point Punto, o std::nullopt.
+ * @return true si se guardó.
+ */
+bool InventoryManager::setReorderPoint(int id, std::optional<int> point)
+{
+    if (!m_dbManager->setReorderPoint(id, point))
+        return false;
+
+    m_alerts.setComponentReorderPoint(id, point);
+    if (const std::optional<Component> comp = getComponentById(id))
+        m_alerts.evaluate(*comp);
+    return true;
+}
+
+/**
+ * @brief Guarda el punto de un tipo y reevalúa los componentes de ese tipo.
+ *
+ * Los componentes del tipo se obtienen con el índice de tipos de la caché, así que el coste
+ * es proporcional a los componentes afectados.
+ *
+ * @param tipo Tipo.
+ * @param point Punto, o std::nullopt.
+ * @return true si se guardó.
+ */
+bool InventoryManager::setTipoReorderPoint(const QString& tipo, std::optional<int> point)
+{
+    if (!m_dbManager->setTipoReorderPoint(tipo, point))
+        return false;
+
+    m_alerts.setTipoReorderPoint(tipo, point);
+    const SearchQuery query = SearchQuery::where(Component::Field::Tipo, SearchQuery::Op::Equals, tipo);
+    if (m_cache.isLoaded()) {
+        for (int row : m_cache.rowsWhere(query))
+            m_alerts.evaluate(m_cache.componentAt(row));
+    } else {
+        for (const Component& comp : m_dbManager->searchComponents(query))
+            m_alerts.evaluate(comp);
+    }
+    return true;
+}
+
+/**
+ * @brief Alertas de antigüedad, tras comprobar cambios externos y de fecha.
+ * @param limit Número máximo de alertas (-1 para todas).
+ * @return Alertas por caducidad.
+ */
+QList<AlertEngine::AgeingAlert> InventoryManager::ageingAlerts(int limit)
+{
+    reloadIfChanged();
+    refreshAgeing();
+    return m_alerts.ageingAlerts(limit);
+}
+
+/**
+ * @brief Reglas de caducidad cargadas en el motor de alertas.
+ * @return Reglas.
+ */
+QList<AlertEngine::AgeingRule> InventoryManager::ageingRules() const
+{
+    return m_alerts.ageingRules();
+}
+
+/**
+ * @brief Guarda una regla y evalúa solo los componentes adquiridos antes de su corte.
+ * @param tipo Tipo (vacío para todos).
+ * @param meses Meses de antigüedad máxima.
+ * @return true si se guardó.
+ */
+bool InventoryManager::addAgeingRule(const QString& tipo, int meses)
+{
+    int id = -1;
+    if (meses <= 0 || !m_dbManager->addAgeingRule(tipo, meses, &id))
+        return false;
+
+    const AlertEngine::AgeingRule rule{id, tipo.trimmed(), meses};
+    QList<AlertEngine::AgeingRule> rules = m_alerts.ageingRules();
+    rules.append(rule);
+    m_alerts.setAgeingRules(rules);
+
+    evaluateAgeingRange(rule, QDate(), AlertEngine::ageingCutoff(rule, m_alerts.today()));
+    return true;
+}
+
+/**
+ * @brief Borra una regla y reevalúa los componentes que estaban en alerta por ella.
+ * @param id ID de la regla.
+ * @return true si se borró.
+ */
+bool InventoryManager::removeAgeingRule(int id)
+{
+    if (!m_dbManager->deleteAgeingRule(id))
+        return false;
+
+    QList<AlertEngine::AgeingRule> rules = m_alerts.ageingRules();
+    rules.erase(std::remove_if(rules.begin(), rules.end(),
+                               [id](const AlertEngine::AgeingRule& rule) { return rule.id == id; }),
+                rules.end());
+    m_alerts.setAgeingRules(rules);
+
+    for (int componentId : m_alerts.agedByRule(id)) {
+        if (const std::optional<Component> comp = getComponentById(componentId))
+            m_alerts.evaluate(*comp);
+    }
+    return true;
+}
+
+/**
+ * @brief Avanza la fecha de referencia de las reglas de caducidad.
+ *
+ * El corte de cada regla (ageingCutoff()) se mueve con la fecha, así que solo pueden
+ * cambiar de estado los componentes adquiridos entre el corte anterior y el nuevo: se
+ * evalúa ese tramo del índice de fechas y nada más. Funciona igual si el reloj retrocede.
+ *
+ * @return true si la fecha había cambiado.
+ */
+bool InventoryManager::refreshAgeing()
+{
+    const QDate today = QDate::currentDate();
+    const QDate previous = m_alerts.today();
+    if (today == previous)
+        return false;
+
+    m_alerts.setToday(today);
+    for (const AlertEngine::AgeingRule& rule : m_alerts.ageingRules()) {
+        const QDate before = AlertEngine::ageingCutoff(rule, previous);
+        const QDate after = AlertEngine::ageingCutoff(rule, today);
+        if (before < after)
+            evaluateAgeingRange(rule, before.addDays(1), after);
+        else if (after < before)
+            evaluateAgeingRange(rule, after.addDays(1), before);
+    }
+    return true;
+}
+
+/**
+ * @brief Devuelve la revisión del AlertEngine.
+ * @return Revisión actual de las alertas.
+ */
+quint64 InventoryManager::alertRevision() const
+{
+    return m_alerts.revision();
+}
+
+/**
+ * @brief Busca con el plan de la caché (o en SQL) los componentes de una regla en un
+ * rango de fechas y los vuelve a evaluar.
+ *
+ * El rango de fechas se resuelve con el índice ordenado de fechas; si la regla tiene tipo,
+ * el planificador puede empezar por el índice de tipos cuando es más selectivo.
+ *
+ * @param rule Regla.
+ * @param from Primera fecha (inválida para no limitar).
+ * @param to Última fecha.
+ */
+void InventoryManager::evaluateAgeingRange(const AlertEngine::AgeingRule& rule,
+                                           const QDate& from, const QDate& to)
+{
+    std::vector<SearchQuery> parts = {
+        SearchQuery::where(Component::Field::FechaAdquisicion, SearchQuery::Op::Between,
+                           from.isValid() ? QVariant(from) : QVariant(), to)
+    };
+    if (!rule.tipo.isEmpty())
+        parts.push_back(SearchQuery::where(Component::Field::Tipo, SearchQuery::Op::Equals, rule.tipo));
+    const SearchQuery query = parts.size() == 1 ? parts.front() : SearchQuery::allOf(parts);
+
+    if (m_cache.isLoaded()) {
+        for (int row : m_cache.rowsWhere(query))
+            m_alerts.evaluate(m_cache.componentAt(row));
+    } else {
+        for (const Component& comp : m_dbManager->searchComponents(query))
+            m_alerts.evaluate(comp);
+    }
+}
+
+/**
+ * @brief Arma el temporizador para un segundo después de la próxima medianoche local.
+ */
+void InventoryManager::scheduleDayBoundary()
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    const QDateTime midnight(now.date().addDays(1), QTime(0, 0));
+    m_dayTimer.start(int(std::min<qint64>(now.msecsTo(midnight) + 1000,
+                                          std::numeric_limits<int>::max())));
+}
+
+/**
+ * @brief Compara PRAGMA data_version con la última lectura y recarga si cambió.
+ *
+ * La versión se lee siempre en la conexión principal (ver DatabaseManager::dataVersion()):
+ * sus propias escrituras no la cambian, así que un cambio solo puede venir de otro proceso o
+ * de las conexiones de otros hilos.
+ *
+ * @return true si se recargó la caché.
+ */
+bool InventoryManager::reloadIfChanged()
+{
+    const qint64 version = m_dbManager->dataVersion();
+    if (version < 0 || version == m_dataVersion)
+        return false;
+
+    m_dataVersion = version;
+    reloadCache();
+    return true;
+}
+
+/**
+ * @brief Busca un resultado válido en la caché de resultados o lo calcula.
+ *
+ * Antes de buscar se comprueba si otro proceso cambió la base de datos. Un resultado de
+ * una generación anterior se recalcula. El coste de cada entrada es su número de
+ * componentes, así que QCache descarta las menos usadas recientemente cuando se supera
+ * ResultCacheCapacity; un resultado mayor que la capacidad no se guarda. En
+ * LoadMode::AlertsOnly no se guarda nada.
+ *
+ * @param key Clave canónica de la búsqueda.
+ * @param compute Función que ejecuta la búsqueda.
+ * @return Componentes encontrados.
+ */
+QList<Component> InventoryManager::cachedResult(const QString& key,
+                                                const std::function<QList<Component>()>& compute)
+{
+    reloadIfChanged();
+    if (m_mode == LoadMode::AlertsOnly)
+        return compute();
+
+    if (const CachedResult* cached = m_results.object(key)) {
+        if (cached->generation == m_generation)
+            return cached->components;
+    }
+
+    QList<Component> components = compute();
+    m_results.insert(key, new CachedResult{m_generation, components}, int(components.size()) + 1);
+    return components;
+}
+
+/**
+ * @brief Pasa a la siguiente generación; los resultados anteriores dejan de ser válidos.
+ */
+void InventoryManager::invalidateResults()
+{
+    ++m_generation;
 }
 
 /**
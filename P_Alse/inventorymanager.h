@@ -1,10 +1,15 @@
 #ifndef INVENTORYMANAGER_H
 #define INVENTORYMANAGER_H
 
+#include <QCache>
 #include <QList>
 #include <QString>
+#include <QTimer>
+#include <functional>
+#include "alertengine.h"
 #include "component.h"
 #include "databasemanager.h"
+#include "inventorycache.h"
 
 /**
  * @class InventoryManager
@@ -13,15 +18,48 @@
  * Esta clase proporciona funciones para agregar, consultar, buscar, actualizar y eliminar
  * componentes en un inventario. Internamente utiliza una instancia de DatabaseManager para
  * manejar operaciones relacionadas con la base de datos.
+ *
+ * Las lecturas, búsquedas y alertas se sirven desde una InventoryCache cargada al crear el
+ * objeto; cada escritura se confirma primero en la base de datos y después se aplica a la
+ * caché, que así permanece sincronizada sin volver a leer el archivo.
+ *
+ * Los resultados de las búsquedas se guardan además en una caché LRU acotada (QCache),
+ * indexada por la forma canónica de la consulta. Cada escritura incrementa un contador de
+ * generación y los resultados de generaciones anteriores se descartan al consultarlos; los
+ * cambios hechos por otros procesos se detectan con PRAGMA data_version, que obliga a
+ * recargar la caché del inventario.
+ *
+ * Las alertas de bajo stock y de antigüedad las mantiene un AlertEngine: cada escritura
+ * vuelve a evaluar solo los componentes que modificó, así que consultar las alertas activas
+ * no recorre el inventario. Al cambiar de día (un temporizador se dispara a medianoche, y
+ * además se comprueba al consultar) solo se evalúan los componentes cuya fecha de
+ * adquisición acaba de cruzar el corte de alguna regla de caducidad, con búsquedas por
+ * rango sobre el índice de fechas.
+ *
+ * Un proceso que solo vigila las alertas (el modo --daemon) usa LoadMode::AlertsOnly: no
+ * se construye la InventoryCache ni se guardan resultados, las lecturas van directamente a
+ * la base de datos y una recarga solo recorre las filas para volver a evaluar las alertas.
  */
 class InventoryManager
 {
 public:
+    /**
+     * @enum LoadMode
+     * @brief Qué se mantiene en memoria.
+     */
+    enum class LoadMode {
+        Full,       ///< Caché del inventario con todos sus índices y caché de resultados.
+        AlertsOnly  ///< Solo el AlertEngine; las lecturas se resuelven en SQL.
+    };
+
     /**
      * @brief Constructor de InventoryManager.
      * Inicializa la base de datos y prepara el entorno para gestionar el inventario.
+     * @param databasePath Ruta del archivo SQLite del inventario.
+     * @param mode Qué se carga en memoria (por defecto, todo).
      */
-    InventoryManager();
+    explicit InventoryManager(const QString& databasePath = "inventory.db",
+                              LoadMode mode = LoadMode::Full);
 
     /**
      * @brief Destructor de InventoryManager.
@@ -29,6 +67,13 @@ public:
      */
     ~InventoryManager();
 
+    /**
+     * @brief Indica si la base de datos se abrió y el inventario está cargado en memoria
+     * (en LoadMode::AlertsOnly, si las alertas se evaluaron).
+     * @return true si el inventario está listo para consultarse.
+     */
+    bool isLoaded() const;
+
     /**
      * @brief Agrega un nuevo componente al inventario.
      * @param comp El componente a agregar.
@@ -36,20 +81,135 @@ public:
      */
     bool addComponent(const Component& comp);
 
+    /**
+     * @brief Agrega varios componentes en bloque, por ejemplo al importar un catálogo de proveedor.
+     * @param comps Componentes a agregar.
+     * @return IDs asignados en el mismo orden; -1 para los componentes que no se pudieron agregar.
+     */
+    QList<int> addComponents(const QList<Component>& comps);
+
     /**
      * @brief Recupera todos los componentes almacenados en el inventario.
      * @return Lista de todos los componentes.
      */
     QList<Component> getAllComponents();
 
+    /**
+     * @brief Recorre todos los componentes uno a uno, sin materializar el inventario completo.
+     * @param visitor Función llamada por cada componente; si devuelve false se detiene.
+     * @return true si el recorrido se pudo realizar.
+     */
+    bool forEachComponent(const ComponentVisitor& visitor);
+
+    /**
+     * @brief Obtiene un componente por su ID sin recorrer el inventario.
+     * @param id ID del componente.
+     * @return El componente, o std::nullopt si no existe.
+     */
+    std::optional<Component> getComponentById(int id);
+
+    /**
+     * @brief Obtiene varios componentes por sus IDs en una sola consulta por lote.
+     * @param ids IDs a buscar.
+     * @return Componentes encontrados, ordenados por ID.
+     */
+    QList<Component> getComponentsByIds(const QList<int>& ids);
+
+    /**
+     * @brief Recupera una página acotada del inventario usando paginación por clave.
+     * @param afterKey Clave devuelta por la página anterior (PageKey() para la primera).
+     * @param limit Número máximo de componentes de la página.
+     * @param sortColumn Campo por el que se ordena.
+     * @return Página de componentes y clave para continuar.
+     */
+    ComponentPage getComponentsPage(const PageKey& afterKey, int limit,
+                                    Component::Field sortColumn = Component::Field::Id);
+
     /**
      * @brief Busca componentes en el inventario según un criterio y palabra clave.
      * @param keyword Palabra clave a buscar.
      * @param criteria Criterio de búsqueda (Nombre, Tipo, Cantidad, Ubicación, Fecha).
+     *        Con "Fecha" se acepta una fecha "aaaa-mm-dd" o un rango "aaaa-mm-dd..aaaa-mm-dd"
+     *        (cualquiera de los extremos puede omitirse).
      * @return Lista de componentes que coinciden con la búsqueda.
      */
     QList<Component> searchComponents(const QString& keyword, const QString& criteria);
 
+    /**
+     * @brief Busca componentes que cumplen una consulta de varios criterios,
+     * por ejemplo tipo=resistor AND cantidad<10.
+     * @param query Consulta (ver SearchQuery).
+     * @return Lista de componentes que cumplen la consulta, ordenados por ID o, si
+     *         SearchQuery::isRankedByRelevance(), por relevancia (bm25).
+     */
+    QList<Component> search(const SearchQuery& query);
+
+    /**
+     * @brief Busca componentes cuyo nombre se parece a @p text aunque tenga errores de escritura.
+     *
+     * Tolera 1 error en textos cortos y hasta 3 en los largos (ver FuzzyMatcher), y un nombre
+     * que contiene el texto tal cual cuenta como coincidencia exacta.
+     *
+     * @param text Nombre o parte del nombre buscado.
+     * @param limit Número máximo de resultados.
+     * @return Componentes ordenados del más al menos parecido.
+     */
+    QList<Component> fuzzySearch(const QString& text, int limit = 50);
+
+    /**
+     * @brief Sugerencias de autocompletado para un campo de texto.
+     * @param field Nombre, Tipo o Ubicacion.
+     * @param prefix Texto escrito hasta ahora (sin distinguir mayúsculas).
+     * @param limit Número máximo de sugerencias.
+     * @return Valores existentes que empiezan por @p prefix, del más al menos usado.
+     */
+    QStringList completions(Component::Field field, const QString& prefix, int limit = 10);
+
+    /**
+     * @brief Busca componentes adquiridos entre dos fechas, ambas incluidas.
+     * @param from Fecha inicial (inválida para no limitar el inicio).
+     * @param to Fecha final (inválida para no limitar el final).
+     * @return Lista de componentes dentro del rango.
+     */
+    QList<Component> searchByDateRange(const QDate& from, const QDate& to);
+
+    /**
+     * @brief Busca componentes con una cantidad entre dos valores, ambos incluidos.
+     * @param min Cantidad mínima.
+     * @param max Cantidad máxima.
+     * @return Lista de componentes dentro del rango, ordenados por ID.
+     */
+    QList<Component> searchByQuantityRange(int min, int max);
+
+    /**
+     * @brief Busca componentes de un tipo exacto.
+     * @param tipo Tipo a buscar.
+     * @return Lista de componentes de ese tipo.
+     */
+    QList<Component> searchByTipo(const QString& tipo);
+
+    /**
+     * @brief Busca componentes guardados en una ubicación exacta.
+     * @param ubicacion Ubicación a buscar.
+     * @return Lista de componentes en esa ubicación.
+     */
+    QList<Component> searchByUbicacion(const QString& ubicacion);
+
+    /**
+     * @brief Los @p k componentes más críticos (con menos cantidad).
+     * @param k Número de componentes.
+     * @return Componentes de menor a mayor cantidad.
+     */
+    QList<Component> lowestStock(int k);
+
+    /**
+     * @brief Las @p k adquisiciones más recientes.
+     * @param k Número de componentes.
+     * @return Componentes de la fecha más reciente a la más antigua; no incluye los que no
+     *         tienen fecha.
+     */
+    QList<Component> mostRecent(int k);
+
     /**
      * @brief Actualiza un componente existente en el inventario.
      * @param id ID del componente a actualizar.
@@ -65,14 +225,173 @@ public:
      */
     bool deleteComponent(int id);
 
+    /**
+     * @brief Alertas de bajo stock activas, de la más a la menos grave.
+     * @param limit Número máximo de alertas, o -1 para todas.
+     * @return Alertas activas (ver AlertEngine).
+     */
+    QList<AlertEngine::Alert> activeAlerts(int limit = -1);
+
+    /**
+     * @brief Punto de reorden que se aplica a un componente.
+     * @param comp Componente.
+     * @return Punto propio, el de su tipo o AlertEngine::DefaultReorderPoint.
+     */
+    int reorderPoint(const Component& comp) const;
+
+    /**
+     * @brief Punto de reorden propio de un componente.
+     * @param id ID del componente.
+     * @return Punto, o std::nullopt si hereda el de su tipo.
+     */
+    std::optional<int> componentReorderPoint(int id) const;
+
+    /**
+     * @brief Punto de reorden de un tipo.
+     * @param tipo Tipo.
+     * @return Punto, o std::nullopt si usa el general.
+     */
+    std::optional<int> tipoReorderPoint(const QString& tipo) const;
+
+    /**
+     * @brief Cambia el punto de reorden propio de un componente y vuelve a evaluar su alerta.
+     * @param id ID del componente.
+     * @param point Nuevo punto, o std::nullopt para heredar el de su tipo.
+     * @return true si se guardó en la base de datos.
+     */
+    bool setReorderPoint(int id, std::optional<int> point);
+
+    /**
+     * @brief Cambia el punto de reorden de un tipo y vuelve a evaluar los componentes de ese tipo.
+     * @param tipo Tipo (sin distinguir mayúsculas ni acentos).
+     * @param point Nuevo punto, o std::nullopt para usar el general.
+     * @return true si se guardó en la base de datos.
+     */
+    bool setTipoReorderPoint(const QString& tipo, std::optional<int> point);
+
+    /**
+     * @brief Alertas de antigüedad activas, de la más a la menos antigua.
+     * @param limit Número máximo de alertas, o -1 para todas.
+     * @return Alertas activas (ver AlertEngine::AgeingAlert).
+     */
+    QList<AlertEngine::AgeingAlert> ageingAlerts(int limit = -1);
+
+    /**
+     * @brief Reglas de caducidad vigentes.
+     * @return Reglas ordenadas por ID.
+     */
+    QList<AlertEngine::AgeingRule> ageingRules() const;
+
+    /**
+     * @brief Agrega una regla de caducidad y evalúa los componentes que ya la incumplen.
+     * @param tipo Tipo al que se aplica (vacío para todos).
+     * @param meses Antigüedad máxima en meses (mayor que 0).
+     * @return true si se guardó en la base de datos.
+     */
+    bool addAgeingRule(const QString& tipo, int meses);
+
+    /**
+     * @brief Elimina una regla de caducidad y vuelve a evaluar los componentes que había
+     * declarado caducados.
+     * @param id ID de la regla.
+     * @return true si se eliminó de la base de datos.
+     */
+    bool removeAgeingRule(int id);
+
+    /**
+     * @brief Actualiza las alertas de antigüedad si la fecha cambió desde la última evaluación.
+     * @return true si la fecha había cambiado.
+     */
+    bool refreshAgeing();
+
+    /**
+     * @brief Revisión de las alertas (AlertEngine::revision()).
+     *
+     * Cambia con cualquier alerta nueva, modificada o resuelta, venga de una escritura, de
+     * una recarga o del cambio de día hecho por m_dayTimer.
+     *
+     * @return Revisión actual.
+     */
+    quint64 alertRevision() const;
+
     /**
      * @brief Devuelve un puntero al administrador de base de datos.
      * @return Puntero a DatabaseManager, útil para otras clases como ReportGenerator.
      */
     DatabaseManager* getDatabaseManager() const;
 
+    /**
+     * @brief Descarta la caché en memoria y la vuelve a cargar desde la base de datos.
+     *
+     * En LoadMode::AlertsOnly solo vuelve a evaluar las alertas.
+     *
+     * @return true si la caché (o las alertas) quedó cargada.
+     */
+    bool reloadCache();
+
+    /**
+     * @brief Recarga la caché si otro proceso modificó la base de datos desde la última
+     * comprobación (PRAGMA data_version).
+     * @return true si hubo cambios externos y se recargó.
+     */
+    bool reloadIfChanged();
+
+    /// Número máximo de componentes guardados entre todos los resultados en caché.
+    static constexpr int ResultCacheCapacity = 200000;
+
 private:
+    /**
+     * @struct CachedResult
+     * @brief Resultado de una búsqueda y la generación de datos en la que se calculó.
+     */
+    struct CachedResult {
+        quint64 generation = 0;        ///< Valor de m_generation al calcularlo.
+        QList<Component> components;   ///< Componentes encontrados.
+    };
+
+    /**
+     * @brief Devuelve el resultado guardado para @p key o lo calcula y lo guarda.
+     * @param key Clave canónica de la búsqueda.
+     * @param compute Función que ejecuta la búsqueda.
+     * @return Componentes encontrados.
+     */
+    QList<Component> cachedResult(const QString& key, const std::function<QList<Component>()>& compute);
+
+    /**
+     * @brief Invalida todos los resultados guardados (tras una escritura).
+     */
+    void invalidateResults();
+
+    /**
+     * @brief Búsqueda aproximada sin pasar por la caché de resultados.
+     * @param matcher Patrón preparado.
+     * @param limit Número máximo de resultados.
+     * @return Componentes ordenados por parecido.
+     */
+    QList<Component> fuzzySearchUncached(const FuzzyMatcher& matcher, int limit);
+
+    /**
+     * @brief Vuelve a evaluar los componentes de una regla adquiridos entre dos fechas.
+     * @param rule Regla de caducidad (aporta el filtro por tipo).
+     * @param from Primera fecha incluida (inválida para no limitar el inicio).
+     * @param to Última fecha incluida.
+     */
+    void evaluateAgeingRange(const AlertEngine::AgeingRule& rule, const QDate& from, const QDate& to);
+
+    /**
+     * @brief Programa m_dayTimer para el comienzo del día siguiente.
+     */
+    void scheduleDayBoundary();
+
     DatabaseManager* m_dbManager; /**< Puntero a la instancia de DatabaseManager utilizada. */
+    LoadMode m_mode;              /**< Qué se mantiene en memoria. */
+    bool m_loaded = false;        /**< Resultado de la última carga (reloadCache()). */
+    InventoryCache m_cache;       /**< Copia columnar del inventario, actualizada en cada escritura. */
+    AlertEngine m_alerts;         /**< Alertas de stock y antigüedad, actualizadas en cada escritura. */
+    QTimer m_dayTimer;            /**< Dispara refreshAgeing() al cambiar de día. */
+    QCache<QString, CachedResult> m_results; /**< Resultados recientes por clave de búsqueda (LRU). */
+    quint64 m_generation = 0;     /**< Se incrementa con cada cambio en los datos. */
+    qint64 m_dataVersion = -1;    /**< Último PRAGMA data_version leído. */
 };
 
 #endif // INVENTORYMANAGER_H
@@ -1,4 +1,5 @@
 #include "inventorytab.h"
+#include "fieldcompleter.h"
 #include <QVBoxLayout>
 #include <QFormLayout>
 #include <QTableWidgetItem>
@@ -35,6 +36,11 @@ InventoryTab::InventoryTab(InventoryManager* manager, QWidget* parent)
     dateEdit->setCalendarPopup(true);
     dateEdit->setDisplayFormat("yyyy-MM-dd");
 
+    // Sugerir los valores ya usados para evitar duplicados escritos de otra forma
+    new FieldCompleter(m_manager, Component::Field::Nombre, nameEdit);
+    new FieldCompleter(m_manager, Component::Field::Tipo, typeEdit);
+    new FieldCompleter(m_manager, Component::Field::Ubicacion, locationEdit);
+
     formLayout->addRow("Nombre:", nameEdit);
     formLayout->addRow("Tipo:", typeEdit);
     formLayout->addRow("Cantidad:", quantitySpin);
@@ -121,20 +127,18 @@ void InventoryTab::handleCellDoubleClicked(int row, int)
     if (!rowToIdMap.contains(row)) return;
 
     int id = rowToIdMap[row];
-    QList<Component> list = m_manager->getAllComponents();
-    for (const Component& comp : list) {
-        if (comp.getId() == id) {
-            nameEdit->setText(comp.getNombre());
-            typeEdit->setText(comp.getTipo());
-            quantitySpin->setValue(comp.getCantidad());
-            locationEdit->setText(comp.getUbicacion());
-            dateEdit->setDate(comp.getFechaAdquisicion());
-
-            editingId = id;
-            addButton->setText("Guardar cambios");
-            break;
-        }
-    }
+    const std::optional<Component> found = m_manager->getComponentById(id);
+    if (!found) return;
+
+    const Component& comp = *found;
+    nameEdit->setText(comp.getNombre());
+    typeEdit->setText(comp.getTipo());
+    quantitySpin->setValue(comp.getCantidad());
+    locationEdit->setText(comp.getUbicacion());
+    dateEdit->setDate(comp.getFechaAdquisicion());
+
+    editingId = id;
+    addButton->setText("Guardar cambios");
 }
 
 /**
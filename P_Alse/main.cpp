@@ -1,10 +1,102 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <cstdio>
+#include <cstring>
+#include "alertdaemon.h"
 #include "mainwindow.h"
 
+namespace {
+
+/**
+ * @brief Busca --daemon en los argumentos antes de crear la aplicación.
+ *
+ * Hace falta saberlo antes de construir QApplication o QCoreApplication, porque solo se
+ * puede crear una de las dos.
+ *
+ * @param argc Número de argumentos.
+ * @param argv Argumentos.
+ * @return true si se pidió el modo sin interfaz gráfica.
+ */
+bool daemonRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--daemon") == 0)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Ejecuta el evaluador de alertas sin interfaz gráfica.
+ *
+ * Opciones: --db (archivo del inventario), --interval (segundos entre comprobaciones) y
+ * --output (archivo al que se agregan los eventos, o - para la salida estándar). En
+ * Windows el ejecutable no tiene consola, así que conviene usar --output con un archivo.
+ *
+ * El inventario se abre en InventoryManager::LoadMode::AlertsOnly: el proceso solo guarda en
+ * memoria las alertas, sin la caché columnar ni sus índices de búsqueda.
+ *
+ * @param argc Número de argumentos.
+ * @param argv Argumentos.
+ * @return Código de salida.
+ */
+int runDaemon(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("P_Alse");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Evalúa las alertas del inventario sin interfaz gráfica.");
+    parser.addHelpOption();
+    const QCommandLineOption daemonOption("daemon", "Ejecuta el evaluador de alertas sin interfaz gráfica.");
+    const QCommandLineOption dbOption("db", "Base de datos del inventario.", "ruta", "inventory.db");
+    const QCommandLineOption intervalOption("interval", "Segundos entre comprobaciones.", "segundos", "30");
+    const QCommandLineOption outputOption("output", "Archivo donde se agregan los eventos (- para la salida estándar).",
+                                          "ruta", "-");
+    parser.addOptions({daemonOption, dbOption, intervalOption, outputOption});
+    parser.process(app);
+
+    bool ok = false;
+    const int interval = parser.value(intervalOption).toInt(&ok);
+    if (!ok || interval <= 0 || interval > 86400) {
+        qWarning() << "Intervalo no válido:" << parser.value(intervalOption);
+        return 1;
+    }
+
+    QFile output;
+    const QString outputPath = parser.value(outputOption);
+    if (outputPath == "-") {
+        ok = output.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+    } else {
+        output.setFileName(outputPath);
+        ok = output.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+    }
+    if (!ok) {
+        qWarning() << "No se pudo abrir la salida de eventos" << outputPath << ":" << output.errorString();
+        return 1;
+    }
+
+    InventoryManager manager(parser.value(dbOption), InventoryManager::LoadMode::AlertsOnly);
+    if (!manager.isLoaded()) {
+        qWarning() << "No se pudo cargar el inventario" << parser.value(dbOption);
+        return 1;
+    }
+
+    AlertDaemon daemon(&manager, &output, interval * 1000);
+    daemon.start();
+    return app.exec();
+}
+
+} // namespace
+
 /**
  * @brief Función principal del programa.
  *
- * Crea una aplicación Qt, instancia la ventana principal y la muestra.
+ * Crea una aplicación Qt, instancia la ventana principal y la muestra. Con --daemon no se
+ * crea ningún widget: se ejecuta el evaluador de alertas (ver runDaemon()).
  *
  * @param argc Número de argumentos de línea de comandos.
  * @param argv Arreglo de argumentos de línea de comandos.
@@ -12,6 +104,9 @@
  */
 int main(int argc, char *argv[])
 {
+    if (daemonRequested(argc, argv))
+        return runDaemon(argc, argv);
+
     QApplication app(argc, argv);
 
     MainWindow window;
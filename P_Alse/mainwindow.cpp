@@ -30,6 +30,13 @@ MainWindow::MainWindow(QWidget* parent)
     m_tabWidget->addTab(searchTab, "Buscar");
     m_tabWidget->addTab(alertsTab, "Alertas");
     m_tabWidget->addTab(reportsTab, "Reportes");
+
+    // Las alertas se mantienen de forma incremental, así que refrescarlas al mostrar la
+    // pestaña solo cuesta leer las filas visibles.
+    connect(m_tabWidget, &QTabWidget::currentChanged, this, [this, alertsTab](int index) {
+        if (m_tabWidget->widget(index) == alertsTab)
+            alertsTab->refreshAlerts();
+    });
 }
 
 /**
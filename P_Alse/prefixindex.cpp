@@ -0,0 +1,161 @@
+/// @file prefixindex.cpp
+/// @brief Implementación de la clase PrefixIndex.
+
+#include "prefixindex.h"
+#include "searchkey.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+/// Orden de las entradas por clave.
+template <typename E>
+bool keyLess(const E& a, const E& b)
+{
+    return a.key < b.key;
+}
+}
+
+/**
+ * @brief Elimina todas las entradas.
+ */
+void PrefixIndex::clear()
+{
+    m_entries.clear();
+    m_pending.clear();
+    m_unused = 0;
+}
+
+/**
+ * @brief Suma un uso a la entrada del valor o la deja pendiente si es nueva.
+ * @param value Valor del campo.
+ */
+void PrefixIndex::insert(const QString& value)
+{
+    if (value.isEmpty())
+        return;
+
+    const QString key = SearchKey::normalize(value);
+    if (Entry* entry = find(key)) {
+        if (entry->count++ == 0) {
+            entry->value = value;
+            --m_unused;
+        }
+        return;
+    }
+    m_pending.append(Entry{key, value, 1});
+}
+
+/**
+ * @brief Resta un uso a la entrada del valor.
+ *
+ * Las entradas que llegan a cero se conservan hasta la siguiente mezcla, donde se eliminan.
+ *
+ * @param value Valor del campo.
+ */
+void PrefixIndex::remove(const QString& value)
+{
+    if (value.isEmpty())
+        return;
+
+    const QString key = SearchKey::normalize(value);
+    Entry* entry = find(key);
+    if (!entry && !m_pending.isEmpty()) {
+        flush();
+        entry = find(key);
+    }
+    if (entry && entry->count > 0 && --entry->count == 0)
+        ++m_unused;
+}
+
+/**
+ * @brief Recorre el tramo del prefijo quedándose con las @p limit entradas más usadas.
+ * @param prefix Texto escrito.
+ * @param limit Número máximo de sugerencias.
+ * @return Sugerencias ordenadas.
+ */
+QStringList PrefixIndex::complete(const QString& prefix, int limit)
+{
+    QStringList suggestions;
+    if (limit <= 0)
+        return suggestions;
+    flush();
+
+    const QString key = SearchKey::normalize(prefix);
+    auto better = [](const Entry* a, const Entry* b) {
+        return a->count != b->count ? a->count > b->count : a->key < b->key;
+    };
+
+    // Montículo con la peor sugerencia en la cima: cada entrada nueva solo compite con ella.
+    QVector<const Entry*> heap;
+    heap.reserve(limit + 1);
+    auto it = std::lower_bound(m_entries.cbegin(), m_entries.cend(), Entry{key, QString(), 0},
+                               keyLess<Entry>);
+    for (; it != m_entries.cend() && it->key.startsWith(key); ++it) {
+        if (it->count == 0)
+            continue;
+        if (heap.size() < limit) {
+            heap.append(&*it);
+            std::push_heap(heap.begin(), heap.end(), better);
+        } else if (better(&*it, heap.first())) {
+            std::pop_heap(heap.begin(), heap.end(), better);
+            heap.last() = &*it;
+            std::push_heap(heap.begin(), heap.end(), better);
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), better);
+    for (const Entry* entry : heap)
+        suggestions.append(entry->value);
+    return suggestions;
+}
+
+/**
+ * @brief Ordena el búfer, une las claves repetidas y lo mezcla con el arreglo.
+ *
+ * Las entradas sin uso se saltan al completar, así que solo se purgan cuando hay claves
+ * nuevas que mezclar o cuando ya son una cuarta parte del arreglo.
+ */
+void PrefixIndex::flush()
+{
+    if (m_pending.isEmpty() && m_unused <= m_entries.size() / 4)
+        return;
+
+    std::stable_sort(m_pending.begin(), m_pending.end(), keyLess<Entry>);
+    QVector<Entry> merged;
+    merged.reserve(m_entries.size() + m_pending.size());
+
+    auto append = [&merged](Entry&& entry) {
+        if (!merged.isEmpty() && merged.last().key == entry.key)
+            merged.last().count += entry.count;
+        else
+            merged.append(std::move(entry));
+    };
+
+    int a = 0;
+    int b = 0;
+    while (a < m_entries.size() || b < m_pending.size()) {
+        if (b == m_pending.size() || (a < m_entries.size() && !(m_pending.at(b).key < m_entries.at(a).key)))
+            append(std::move(m_entries[a++]));
+        else
+            append(std::move(m_pending[b++]));
+    }
+
+    merged.erase(std::remove_if(merged.begin(), merged.end(),
+                                [](const Entry& entry) { return entry.count == 0; }),
+                 merged.end());
+    m_entries = std::move(merged);
+    m_pending.clear();
+    m_unused = 0;
+}
+
+/**
+ * @brief Búsqueda binaria de una clave.
+ * @param key Clave normalizada.
+ * @return Entrada encontrada o nullptr.
+ */
+PrefixIndex::Entry* PrefixIndex::find(const QString& key)
+{
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), Entry{key, QString(), 0},
+                               keyLess<Entry>);
+    return it != m_entries.end() && it->key == key ? &*it : nullptr;
+}
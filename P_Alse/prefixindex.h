@@ -0,0 +1,82 @@
+#ifndef PREFIXINDEX_H
+#define PREFIXINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/// @file prefixindex.h
+/// @brief Declaración de la clase PrefixIndex, índice de autocompletado por prefijo.
+
+/**
+ * @class PrefixIndex
+ * @brief Valores distintos de un campo con su frecuencia, ordenados para completar prefijos.
+ *
+ * Cada valor se guarda una vez, con su clave normalizada (SearchKey) y el número de
+ * componentes que lo usan, en un arreglo ordenado por clave. Los valores que solo difieren
+ * en mayúsculas o acentos comparten entrada y se sugieren con la primera forma registrada, lo que
+ * ayuda a no crear duplicados como "Resistor" y "resistor".
+ *
+ * Las claves nuevas se acumulan en un búfer y se mezclan con el arreglo en la siguiente
+ * consulta, de modo que cargar un inventario grande no desplaza el arreglo en cada alta.
+ */
+class PrefixIndex {
+public:
+    /**
+     * @brief Vacía el índice.
+     */
+    void clear();
+
+    /**
+     * @brief Registra un uso de un valor.
+     * @param value Valor del campo; los vacíos se ignoran.
+     */
+    void insert(const QString& value);
+
+    /**
+     * @brief Retira un uso de un valor registrado antes con insert().
+     * @param value Valor del campo.
+     */
+    void remove(const QString& value);
+
+    /**
+     * @brief Valores más frecuentes que empiezan por @p prefix, sin distinguir mayúsculas ni acentos.
+     *
+     * Las claves con el prefijo forman un tramo contiguo del arreglo: se localiza por
+     * búsqueda binaria y se recorre con un montículo acotado a @p limit elementos.
+     *
+     * @param prefix Texto escrito hasta ahora.
+     * @param limit Número máximo de sugerencias.
+     * @return Sugerencias de la más a la menos usada (a igual uso, en orden alfabético).
+     */
+    QStringList complete(const QString& prefix, int limit);
+
+private:
+    /**
+     * @struct Entry
+     * @brief Valor distinto y su frecuencia.
+     */
+    struct Entry {
+        QString key;    ///< Clave normalizada (clave de orden).
+        QString value;  ///< Forma en que se sugiere.
+        int count = 0;  ///< Componentes que usan el valor.
+    };
+
+    /**
+     * @brief Mezcla el búfer de claves nuevas con el arreglo y quita las entradas sin uso.
+     */
+    void flush();
+
+    /**
+     * @brief Busca una clave en el arreglo ordenado.
+     * @param key Clave normalizada.
+     * @return Entrada, o nullptr si no está.
+     */
+    Entry* find(const QString& key);
+
+    QVector<Entry> m_entries; ///< Entradas ordenadas por clave.
+    QVector<Entry> m_pending; ///< Entradas nuevas aún sin mezclar.
+    int m_unused = 0;         ///< Entradas del arreglo con frecuencia cero.
+};
+
+#endif // PREFIXINDEX_H
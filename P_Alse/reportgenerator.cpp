@@ -2,8 +2,6 @@
 #include "databasemanager.h"
 #include <QtPrintSupport/QPrinter>
 #include <QTextDocument>
-#include <QSqlQuery>
-#include <QSqlRecord>
 #include <QFile>
 #include <QTextStream>
 #include <QDebug>
@@ -35,33 +33,24 @@ void ReportGenerator::generatePDF(const QString& fileName)
         return;
     }
 
-    QSqlQuery query = m_dbManager->getAllComponentQuery();
-    if (!query.isActive()) {
-        qWarning() << "No se pudo obtener los componentes desde la base de datos.";
-        return;
-    }
-
     int total = 0;
     QString tableRows;
 
-    if (query.next()) {
-        QSqlRecord rec = query.record();
-        int idxNombre     = rec.indexOf("nombre");
-        int idxTipo       = rec.indexOf("tipo");
-        int idxCantidad   = rec.indexOf("cantidad");
-        int idxUbicacion  = rec.indexOf("ubicacion");
-        int idxFecha      = rec.indexOf("fechaAdquisicion");
-
-        do {
-            tableRows += "<tr>";
-            tableRows += "<td>" + query.value(idxNombre).toString() + "</td>";
-            tableRows += "<td>" + query.value(idxTipo).toString() + "</td>";
-            tableRows += "<td>" + query.value(idxCantidad).toString() + "</td>";
-            tableRows += "<td>" + query.value(idxUbicacion).toString() + "</td>";
-            tableRows += "<td>" + query.value(idxFecha).toString() + "</td>";
-            tableRows += "</tr>";
-            total++;
-        } while (query.next());
+    // Los componentes se leen uno a uno con una consulta de solo avance.
+    const bool ok = m_dbManager->forEachComponent([&](const Component& comp) {
+        tableRows += "<tr>";
+        tableRows += "<td>" + comp.getNombre() + "</td>";
+        tableRows += "<td>" + comp.getTipo() + "</td>";
+        tableRows += "<td>" + QString::number(comp.getCantidad()) + "</td>";
+        tableRows += "<td>" + comp.getUbicacion() + "</td>";
+        tableRows += "<td>" + comp.getFechaAdquisicion().toString("yyyy-MM-dd") + "</td>";
+        tableRows += "</tr>";
+        total++;
+        return true;
+    });
+    if (!ok) {
+        qWarning() << "No se pudo obtener los componentes desde la base de datos.";
+        return;
     }
 
     QPrinter printer(QPrinter::HighResolution);
@@ -99,12 +88,6 @@ void ReportGenerator::generateCSV(const QString& fileName)
         return;
     }
 
-    QSqlQuery query = m_dbManager->getAllComponentQuery();
-    if (!query.isActive()) {
-        qWarning() << "No se pudo obtener los componentes desde la base de datos.";
-        return;
-    }
-
     QFile file(fileName);
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
         qWarning() << "No se pudo abrir el archivo para escritura: " << fileName;
@@ -114,13 +97,17 @@ void ReportGenerator::generateCSV(const QString& fileName)
     QTextStream out(&file);
     out << "Nombre,Tipo,Cantidad,Ubicación,Fecha\n";
 
-    while (query.next()) {
-        out << query.value("nombre").toString() << ","
-            << query.value("tipo").toString() << ","
-            << query.value("cantidad").toString() << ","
-            << query.value("ubicacion").toString() << ","
-            << query.value("fechaAdquisicion").toString() << "\n";
-    }
+    // Cada fila se escribe en cuanto se lee, sin acumular el inventario en memoria.
+    const bool ok = m_dbManager->forEachComponent([&out](const Component& comp) {
+        out << comp.getNombre() << ","
+            << comp.getTipo() << ","
+            << comp.getCantidad() << ","
+            << comp.getUbicacion() << ","
+            << comp.getFechaAdquisicion().toString("yyyy-MM-dd") << "\n";
+        return true;
+    });
+    if (!ok)
+        qWarning() << "No se pudo obtener los componentes desde la base de datos.";
 
     file.close();
 }
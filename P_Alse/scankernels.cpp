@@ -0,0 +1,215 @@
+/// @file scankernels.cpp
+/// @brief Implementación de los recorridos vectorizados de ScanKernels.
+
+#include "scankernels.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SCANKERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/// Firma común de las implementaciones de selectBetween.
+using BetweenKernel = void (*)(const qint32*, int, qint32, qint32, quint64*);
+
+/**
+ * @brief Versión escalar: sin saltos, un bit por fila.
+ */
+void selectBetweenScalar(const qint32* column, int count, qint32 min, qint32 max, quint64* bitmap)
+{
+    const int words = ScanKernels::bitmapWords(count);
+    for (int w = 0; w < words; ++w) {
+        const int base = w * 64;
+        const int end = count - base < 64 ? count - base : 64;
+        quint64 bits = 0;
+        for (int i = 0; i < end; ++i) {
+            const qint32 value = column[base + i];
+            bits |= quint64(value >= min && value <= max) << i;
+        }
+        bitmap[w] = bits;
+    }
+}
+
+#ifdef SCANKERNELS_X86
+
+/**
+ * @brief Versión SSE2: compara 4 valores por instrucción (16 pasos por palabra).
+ *
+ * Un valor está fuera del rango si min > valor o valor > max; la máscara de cada paso se
+ * extrae con movemask y se coloca en su posición dentro de la palabra.
+ */
+__attribute__((target("sse2")))
+void selectBetweenSse2(const qint32* column, int count, qint32 min, qint32 max, quint64* bitmap)
+{
+    const __m128i low = _mm_set1_epi32(min);
+    const __m128i high = _mm_set1_epi32(max);
+    const int fullWords = count / 64;
+
+    for (int w = 0; w < fullWords; ++w) {
+        const qint32* block = column + w * 64;
+        quint64 bits = 0;
+        for (int step = 0; step < 16; ++step) {
+            const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + step * 4));
+            const __m128i outside = _mm_or_si128(_mm_cmpgt_epi32(low, values),
+                                                 _mm_cmpgt_epi32(values, high));
+            const int mask = ~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xF;
+            bits |= quint64(mask) << (step * 4);
+        }
+        bitmap[w] = bits;
+    }
+
+    const int done = fullWords * 64;
+    if (done < count)
+        selectBetweenScalar(column + done, count - done, min, max, bitmap + fullWords);
+}
+
+/**
+ * @brief Versión AVX2: compara 8 valores por instrucción (8 pasos por palabra).
+ */
+__attribute__((target("avx2")))
+void selectBetweenAvx2(const qint32* column, int count, qint32 min, qint32 max, quint64* bitmap)
+{
+    const __m256i low = _mm256_set1_epi32(min);
+    const __m256i high = _mm256_set1_epi32(max);
+    const int fullWords = count / 64;
+
+    for (int w = 0; w < fullWords; ++w) {
+        const qint32* block = column + w * 64;
+        quint64 bits = 0;
+        for (int step = 0; step < 8; ++step) {
+            const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + step * 8));
+            const __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(low, values),
+                                                    _mm256_cmpgt_epi32(values, high));
+            const int mask = ~_mm256_movemask_ps(_mm256_castsi256_ps(outside)) & 0xFF;
+            bits |= quint64(mask) << (step * 8);
+        }
+        bitmap[w] = bits;
+    }
+
+    const int done = fullWords * 64;
+    if (done < count)
+        selectBetweenScalar(column + done, count - done, min, max, bitmap + fullWords);
+}
+
+#endif // SCANKERNELS_X86
+
+/**
+ * @brief Elige la mejor implementación disponible en este procesador.
+ * @param name Recibe el nombre de la implementación.
+ * @return Función elegida.
+ */
+BetweenKernel chooseBetweenKernel(const char** name)
+{
+#ifdef SCANKERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "avx2";
+        return selectBetweenAvx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        *name = "sse2";
+        return selectBetweenSse2;
+    }
+#endif
+    *name = "escalar";
+    return selectBetweenScalar;
+}
+
+/**
+ * @struct Dispatch
+ * @brief Implementación elegida, inicializada una sola vez (de forma segura entre hilos).
+ */
+struct Dispatch {
+    const char* name = nullptr;             ///< Nombre de la implementación.
+    BetweenKernel between = nullptr;        ///< Implementación de selectBetween.
+
+    Dispatch() { between = chooseBetweenKernel(&name); }
+};
+
+const Dispatch& dispatch()
+{
+    static const Dispatch instance;
+    return instance;
+}
+
+/**
+ * @brief Posición del bit menos significativo a 1 de una palabra distinta de cero.
+ */
+inline int lowestBit(quint64 word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+/**
+ * @brief Número de bits a 1 de una palabra.
+ */
+inline int popcount(quint64 word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int bits = 0;
+    for (; word; word &= word - 1)
+        ++bits;
+    return bits;
+#endif
+}
+
+} // namespace
+
+namespace ScanKernels {
+
+/**
+ * @brief Filtro por rango con la implementación elegida para el procesador.
+ */
+void selectBetween(const qint32* column, int count, qint32 min, qint32 max, quint64* bitmap)
+{
+    if (count <= 0)
+        return;
+    dispatch().between(column, count, min, max, bitmap);
+}
+
+/**
+ * @brief Suma los bits de todas las palabras del mapa.
+ */
+int countSelected(const quint64* bitmap, int words)
+{
+    int total = 0;
+    for (int w = 0; w < words; ++w)
+        total += popcount(bitmap[w]);
+    return total;
+}
+
+/**
+ * @brief Recorre solo los bits a 1 de cada palabra (las palabras vacías se saltan enteras).
+ */
+QVector<int> selectedRows(const quint64* bitmap, int words)
+{
+    QVector<int> rows;
+    rows.reserve(countSelected(bitmap, words));
+    for (int w = 0; w < words; ++w) {
+        for (quint64 word = bitmap[w]; word; word &= word - 1)
+            rows.append(w * 64 + lowestBit(word));
+    }
+    return rows;
+}
+
+/**
+ * @brief Nombre de la implementación elegida.
+ */
+const char* implementation()
+{
+    return dispatch().name;
+}
+
+} // namespace ScanKernels
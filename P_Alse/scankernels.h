@@ -0,0 +1,62 @@
+#ifndef SCANKERNELS_H
+#define SCANKERNELS_H
+
+#include <QVector>
+
+/// @file scankernels.h
+/// @brief Recorridos vectorizados (SIMD) de columnas de enteros que producen mapas de selección.
+
+/**
+ * @namespace ScanKernels
+ * @brief Filtros por rango sobre columnas contiguas de enteros de 32 bits.
+ *
+ * Cada filtro escribe un mapa de bits de selección: el bit i de la palabra i / 64 vale 1
+ * si la fila i cumple la condición. La comparación se hace con AVX2 (8 valores por
+ * instrucción) o SSE2 (4 valores) según lo que admita el procesador, comprobado una vez al
+ * primer uso; en otras arquitecturas o compiladores se usa la versión escalar, que produce
+ * el mismo resultado.
+ */
+namespace ScanKernels {
+
+/**
+ * @brief Número de palabras de 64 bits que necesita el mapa de @p count filas.
+ * @param count Número de filas.
+ * @return Palabras del mapa.
+ */
+inline int bitmapWords(int count) { return (count + 63) / 64; }
+
+/**
+ * @brief Marca las filas cuyo valor está entre @p min y @p max (ambos incluidos).
+ * @param column Columna de valores.
+ * @param count Número de filas.
+ * @param min Valor mínimo.
+ * @param max Valor máximo.
+ * @param bitmap Destino con bitmapWords(count) palabras; se sobrescribe por completo.
+ */
+void selectBetween(const qint32* column, int count, qint32 min, qint32 max, quint64* bitmap);
+
+/**
+ * @brief Cuenta las filas marcadas en un mapa de selección.
+ * @param bitmap Mapa de bits.
+ * @param words Número de palabras.
+ * @return Filas seleccionadas.
+ */
+int countSelected(const quint64* bitmap, int words);
+
+/**
+ * @brief Convierte un mapa de selección en la lista de filas marcadas, en orden creciente.
+ * @param bitmap Mapa de bits.
+ * @param words Número de palabras.
+ * @return Filas seleccionadas.
+ */
+QVector<int> selectedRows(const quint64* bitmap, int words);
+
+/**
+ * @brief Implementación elegida para este procesador.
+ * @return "avx2", "sse2" o "escalar".
+ */
+const char* implementation();
+
+} // namespace ScanKernels
+
+#endif // SCANKERNELS_H
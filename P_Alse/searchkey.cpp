@@ -0,0 +1,41 @@
+/// @file searchkey.cpp
+/// @brief Implementación de la normalización de SearchKey.
+
+#include "searchkey.h"
+
+namespace SearchKey {
+
+/**
+ * @brief Descompone, quita las marcas diacríticas y pasa a minúsculas.
+ *
+ * Los textos ASCII sin mayúsculas, que son la mayoría en un inventario, se devuelven sin
+ * copiarlos.
+ *
+ * @param text Texto original.
+ * @return Clave normalizada.
+ */
+QString normalize(const QString& text)
+{
+    bool plain = true;
+    for (QChar c : text) {
+        if (c.unicode() >= 0x80 || (c.unicode() >= 'A' && c.unicode() <= 'Z')) {
+            plain = false;
+            break;
+        }
+    }
+    if (plain)
+        return text;
+
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+    QString stripped;
+    stripped.reserve(decomposed.size());
+    for (QChar c : decomposed) {
+        if (!c.isMark())
+            stripped.append(c);
+    }
+
+    const QString key = stripped.toCaseFolded();
+    return key == text ? text : key;
+}
+
+} // namespace SearchKey
@@ -0,0 +1,30 @@
+#ifndef SEARCHKEY_H
+#define SEARCHKEY_H
+
+#include <QString>
+
+/// @file searchkey.h
+/// @brief Claves de búsqueda normalizadas para comparar textos sin acentos ni mayúsculas.
+
+/**
+ * @namespace SearchKey
+ * @brief Normalización de textos para las búsquedas.
+ *
+ * La clave de un texto es su descomposición de compatibilidad (NFKD) sin marcas
+ * diacríticas y en minúsculas (case folding): "Ubicación" y "UBICACION" tienen la misma
+ * clave "ubicacion", y "ﬁ" (ligadura) se compara como "fi". Las claves se calculan una vez
+ * al escribir (columnas *_clave de la base de datos y columnas de InventoryCache), así que
+ * comparar dos claves es una comparación binaria de cadenas sin trabajo por fila.
+ */
+namespace SearchKey {
+
+/**
+ * @brief Calcula la clave de búsqueda de un texto.
+ * @param text Texto original.
+ * @return Clave normalizada; comparte memoria con @p text si ya estaba normalizado.
+ */
+QString normalize(const QString& text);
+
+} // namespace SearchKey
+
+#endif // SEARCHKEY_H
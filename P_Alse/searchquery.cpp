@@ -0,0 +1,441 @@
+/// @file searchquery.cpp
+/// @brief Implementación de la clase SearchQuery y de su intérprete de texto.
+
+#include "searchquery.h"
+#include "searchkey.h"
+#include <QDate>
+#include <QStringList>
+
+namespace {
+/**
+ * @brief Intérprete descendente recursivo de consultas de texto.
+ *
+ * Gramática (AND tiene prioridad sobre OR):
+ * @code
+ * expresion := termino (OR termino)*
+ * termino   := factor (AND factor)*
+ * factor    := '(' expresion ')' | campo operador valor
+ * @endcode
+ */
+class QueryParser {
+public:
+    explicit QueryParser(const QString& text) : m_text(text) {}
+
+    /**
+     * @brief Interpreta el texto completo.
+     * @return Consulta, o una no válida si hay errores (ver error()).
+     */
+    SearchQuery parse()
+    {
+        SearchQuery query = expression();
+        skipSpaces();
+        if (m_error.isEmpty() && m_pos < m_text.size())
+            fail(QString("Texto inesperado en la posición %1").arg(m_pos + 1));
+        return m_error.isEmpty() ? query : SearchQuery();
+    }
+
+    /**
+     * @brief Descripción del primer error encontrado.
+     * @return Texto del error, vacío si no hubo.
+     */
+    QString error() const { return m_error; }
+
+private:
+    SearchQuery expression()
+    {
+        std::vector<SearchQuery> parts{term()};
+        while (m_error.isEmpty() && keyword("OR"))
+            parts.push_back(term());
+        return parts.size() == 1 ? parts.front() : SearchQuery::anyOf(parts);
+    }
+
+    SearchQuery term()
+    {
+        std::vector<SearchQuery> parts{factor()};
+        while (m_error.isEmpty() && keyword("AND"))
+            parts.push_back(factor());
+        return parts.size() == 1 ? parts.front() : SearchQuery::allOf(parts);
+    }
+
+    SearchQuery factor()
+    {
+        skipSpaces();
+        if (!m_error.isEmpty())
+            return SearchQuery();
+
+        if (peek() == '(') {
+            ++m_pos;
+            SearchQuery inner = expression();
+            skipSpaces();
+            if (peek() != ')') {
+                fail("Falta cerrar un paréntesis");
+                return SearchQuery();
+            }
+            ++m_pos;
+            return inner;
+        }
+        return condition();
+    }
+
+    SearchQuery condition()
+    {
+        const int start = m_pos;
+        while (m_pos < m_text.size() && m_text.at(m_pos).isLetter())
+            ++m_pos;
+        const QString name = m_text.mid(start, m_pos - start).toLower();
+
+        Component::Field field;
+        if (name == "nombre")
+            field = Component::Field::Nombre;
+        else if (name == "tipo")
+            field = Component::Field::Tipo;
+        else if (name == "cantidad")
+            field = Component::Field::Cantidad;
+        else if (name == "ubicacion" || name == "ubicación")
+            field = Component::Field::Ubicacion;
+        else if (name == "fecha")
+            field = Component::Field::FechaAdquisicion;
+        else if (name == "id")
+            field = Component::Field::Id;
+        else {
+            fail(name.isEmpty() ? QString("Se esperaba un campo en la posición %1").arg(start + 1)
+                                : QString("Campo desconocido: %1").arg(name));
+            return SearchQuery();
+        }
+
+        skipSpaces();
+        SearchQuery::Op op;
+        switch (peek().unicode()) {
+        case '=': op = SearchQuery::Op::Equals; break;
+        case '<': op = SearchQuery::Op::Less; break;
+        case '>': op = SearchQuery::Op::Greater; break;
+        case '~': op = SearchQuery::Op::Contains; break;
+        case '^': op = SearchQuery::Op::Prefix; break;
+        default:
+            fail(QString("Se esperaba un operador (= < > ~ ^) después de %1").arg(name));
+            return SearchQuery();
+        }
+        ++m_pos;
+
+        skipSpaces();
+        const QString text = value();
+        if (!m_error.isEmpty())
+            return SearchQuery();
+
+        QVariant low;
+        QVariant high;
+        const int range = text.indexOf("..");
+        if (op == SearchQuery::Op::Equals && range >= 0 && field != Component::Field::Nombre
+            && field != Component::Field::Tipo && field != Component::Field::Ubicacion) {
+            op = SearchQuery::Op::Between;
+            if (!convert(field, text.left(range).trimmed(), low, true)
+                || !convert(field, text.mid(range + 2).trimmed(), high, true))
+                return SearchQuery();
+        } else if (!convert(field, text, low, false)) {
+            return SearchQuery();
+        }
+
+        if (!SearchQuery::supports(field, op)) {
+            fail(QString("El operador no se puede usar con %1").arg(name));
+            return SearchQuery();
+        }
+        return SearchQuery::where(field, op, low, high);
+    }
+
+    /**
+     * @brief Lee un valor: entre comillas dobles o hasta el siguiente espacio o paréntesis.
+     * @return Texto del valor.
+     */
+    QString value()
+    {
+        if (peek() == '"') {
+            const int close = m_text.indexOf('"', m_pos + 1);
+            if (close < 0) {
+                fail("Faltan las comillas de cierre");
+                return QString();
+            }
+            const QString quoted = m_text.mid(m_pos + 1, close - m_pos - 1);
+            m_pos = close + 1;
+            return quoted;
+        }
+
+        const int start = m_pos;
+        while (m_pos < m_text.size() && !m_text.at(m_pos).isSpace() && m_text.at(m_pos) != ')')
+            ++m_pos;
+        if (m_pos == start)
+            fail(QString("Falta el valor en la posición %1").arg(start + 1));
+        return m_text.mid(start, m_pos - start);
+    }
+
+    /**
+     * @brief Convierte el texto de un valor al tipo del campo.
+     * @param field Campo.
+     * @param text Texto del valor.
+     * @param result Recibe el valor convertido.
+     * @param allowEmpty Si es true, un texto vacío da un valor nulo (extremo abierto).
+     * @return false si el texto no es válido para el campo.
+     */
+    bool convert(Component::Field field, const QString& text, QVariant& result, bool allowEmpty)
+    {
+        if (text.isEmpty() && allowEmpty) {
+            result = QVariant();
+            return true;
+        }
+
+        switch (field) {
+        case Component::Field::Id:
+        case Component::Field::Cantidad: {
+            bool ok = false;
+            const int number = text.toInt(&ok);
+            if (!ok) {
+                fail(QString("Número no válido: %1").arg(text));
+                return false;
+            }
+            result = number;
+            return true;
+        }
+        case Component::Field::FechaAdquisicion: {
+            const QDate date = QDate::fromString(text, "yyyy-MM-dd");
+            if (!date.isValid()) {
+                fail(QString("Fecha no válida (aaaa-mm-dd): %1").arg(text));
+                return false;
+            }
+            result = date;
+            return true;
+        }
+        case Component::Field::Nombre:
+        case Component::Field::Tipo:
+        case Component::Field::Ubicacion:
+            result = text;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Consume una palabra reservada (sin distinguir mayúsculas) seguida de un separador.
+     * @param word Palabra a consumir.
+     * @return true si estaba en la posición actual.
+     */
+    bool keyword(const QString& word)
+    {
+        skipSpaces();
+        const int end = m_pos + word.size();
+        if (end > m_text.size() || m_text.mid(m_pos, word.size()).compare(word, Qt::CaseInsensitive) != 0)
+            return false;
+        if (end < m_text.size() && !m_text.at(end).isSpace() && m_text.at(end) != '(')
+            return false;
+        m_pos = end;
+        return true;
+    }
+
+    QChar peek() const { return m_pos < m_text.size() ? m_text.at(m_pos) : QChar(); }
+
+    void skipSpaces()
+    {
+        while (m_pos < m_text.size() && m_text.at(m_pos).isSpace())
+            ++m_pos;
+    }
+
+    void fail(const QString& message)
+    {
+        if (m_error.isEmpty())
+            m_error = message;
+    }
+
+    QString m_text;   ///< Texto de la consulta.
+    int m_pos = 0;    ///< Posición de lectura.
+    QString m_error;  ///< Primer error encontrado.
+};
+}
+
+/**
+ * @brief Crea una consulta de una condición.
+ * @param field Campo.
+ * @param op Operador.
+ * @param value Valor o límite inferior.
+ * @param upper Límite superior (solo Between).
+ * @return Consulta; no válida si el operador no se aplica al campo.
+ */
+SearchQuery SearchQuery::where(Component::Field field, Op op, const QVariant& value, const QVariant& upper)
+{
+    SearchQuery query;
+    query.m_kind = Kind::Condition;
+    query.m_condition = Condition{field, op, value, upper};
+    query.m_valid = supports(field, op) && (op == Op::Between || !value.isNull());
+    return query;
+}
+
+/**
+ * @brief Crea un nodo AND.
+ * @param parts Subconsultas.
+ * @return Consulta; no válida si alguna parte no lo es o no hay partes.
+ */
+SearchQuery SearchQuery::allOf(const std::vector<SearchQuery>& parts)
+{
+    SearchQuery query;
+    query.m_kind = Kind::And;
+    query.m_parts = parts;
+    query.m_valid = !parts.empty();
+    for (const SearchQuery& part : parts)
+        query.m_valid = query.m_valid && part.isValid();
+    return query;
+}
+
+/**
+ * @brief Crea un nodo OR.
+ * @param parts Subconsultas.
+ * @return Consulta; no válida si alguna parte no lo es o no hay partes.
+ */
+SearchQuery SearchQuery::anyOf(const std::vector<SearchQuery>& parts)
+{
+    SearchQuery query = allOf(parts);
+    query.m_kind = Kind::Or;
+    return query;
+}
+
+/**
+ * @brief Interpreta una consulta de texto.
+ * @param text Texto de la consulta.
+ * @param error Recibe el mensaje de error, si lo hay.
+ * @return Consulta interpretada.
+ */
+SearchQuery SearchQuery::parse(const QString& text, QString* error)
+{
+    QueryParser parser(text);
+    SearchQuery query = parser.parse();
+    if (error)
+        *error = parser.error();
+    return query;
+}
+
+/**
+ * @brief Traduce un criterio simple de la pestaña de búsqueda a una consulta.
+ * @param keyword Texto introducido.
+ * @param criteria Criterio (Nombre, Tipo, Cantidad, Ubicación o Fecha).
+ * @return Consulta equivalente.
+ */
+SearchQuery SearchQuery::fromCriteria(const QString& keyword, const QString& criteria)
+{
+    if (criteria == "Nombre")
+        return where(Component::Field::Nombre, Op::Contains, keyword);
+    if (criteria == "Tipo")
+        return where(Component::Field::Tipo, Op::Contains, keyword);
+    if (criteria == "Ubicación")
+        return where(Component::Field::Ubicacion, Op::Contains, keyword);
+
+    if (criteria == "Cantidad") {
+        bool ok = false;
+        const int cantidad = keyword.trimmed().toInt(&ok);
+        return ok ? where(Component::Field::Cantidad, Op::Equals, cantidad) : SearchQuery();
+    }
+
+    if (criteria == "Fecha") {
+        const QString text = keyword.trimmed();
+        const int separator = text.indexOf("..");
+        if (separator >= 0) {
+            const QString fromText = text.left(separator).trimmed();
+            const QString toText = text.mid(separator + 2).trimmed();
+            const QDate from = QDate::fromString(fromText, "yyyy-MM-dd");
+            const QDate to = QDate::fromString(toText, "yyyy-MM-dd");
+            if ((!fromText.isEmpty() && !from.isValid()) || (!toText.isEmpty() && !to.isValid()))
+                return SearchQuery();
+            return where(Component::Field::FechaAdquisicion, Op::Between,
+                         from.isValid() ? QVariant(from) : QVariant(),
+                         to.isValid() ? QVariant(to) : QVariant());
+        }
+
+        const QDate fecha = QDate::fromString(text, "yyyy-MM-dd");
+        return fecha.isValid() ? where(Component::Field::FechaAdquisicion, Op::Between, fecha, fecha)
+                               : SearchQuery();
+    }
+
+    return SearchQuery();
+}
+
+/**
+ * @brief Indica si la consulta está bien formada.
+ * @return true si se puede ejecutar.
+ */
+bool SearchQuery::isValid() const
+{
+    return m_valid;
+}
+
+/**
+ * @brief Comprueba si la consulta es una sola condición de subcadena sobre el nombre.
+ * @return true si se ordena por relevancia.
+ */
+bool SearchQuery::isRankedByRelevance() const
+{
+    return m_valid && m_kind == Kind::Condition
+        && m_condition.field == Component::Field::Nombre && m_condition.op == Op::Contains
+        && SearchKey::normalize(m_condition.value.toString()).size() >= 3;
+}
+
+/**
+ * @brief Escribe la consulta en forma canónica.
+ *
+ * Los valores de texto van entre comillas con \\ y " escapados, así que la clave se puede
+ * leer sin ambigüedad aunque el valor contenga comillas, paréntesis o " AND ".
+ *
+ * @return Clave de la consulta.
+ */
+QString SearchQuery::key() const
+{
+    if (!m_valid)
+        return QString();
+
+    if (m_kind != Kind::Condition) {
+        QStringList parts;
+        for (const SearchQuery& part : m_parts)
+            parts << part.key();
+        return "(" + parts.join(m_kind == Kind::And ? " AND " : " OR ") + ")";
+    }
+
+    auto text = [this](const QVariant& value) -> QString {
+        if (value.isNull())
+            return QString();
+        switch (m_condition.field) {
+        case Component::Field::Id:
+        case Component::Field::Cantidad:
+            return QString::number(value.toInt());
+        case Component::Field::FechaAdquisicion:
+            return value.toDate().toString("yyyy-MM-dd");
+        default: {
+            // Se escapan \ y " para que un valor no pueda cerrar la cadena e imitar otra consulta.
+            QString escaped = SearchKey::normalize(value.toString());
+            escaped.replace("\\", "\\\\").replace("\"", "\\\"");
+            return "\"" + escaped + "\"";
+        }
+        }
+    };
+
+    static const char* const fields[] = {"id", "nombre", "tipo", "cantidad", "ubicacion", "fecha"};
+    static const char* const ops[] = {"=", "<", ">", "=", "~", "^"};
+    QString key = QString(fields[int(m_condition.field)]) + ops[int(m_condition.op)] + text(m_condition.value);
+    if (m_condition.op == Op::Between)
+        key += ".." + text(m_condition.upper);
+    return key;
+}
+
+/**
+ * @brief Comprueba que un operador tenga sentido para un campo.
+ * @param field Campo.
+ * @param op Operador.
+ * @return true si la combinación es válida.
+ */
+bool SearchQuery::supports(Component::Field field, Op op)
+{
+    switch (field) {
+    case Component::Field::Id:
+    case Component::Field::Cantidad:
+    case Component::Field::FechaAdquisicion:
+        return op == Op::Equals || op == Op::Less || op == Op::Greater || op == Op::Between;
+    case Component::Field::Nombre:
+    case Component::Field::Tipo:
+    case Component::Field::Ubicacion:
+        return op == Op::Equals || op == Op::Contains || op == Op::Prefix;
+    }
+    return false;
+}
@@ -0,0 +1,183 @@
+#ifndef SEARCHQUERY_H
+#define SEARCHQUERY_H
+
+#include <QString>
+#include <QVariant>
+#include <vector>
+#include "component.h"
+
+/// @file searchquery.h
+/// @brief Declaración de la clase SearchQuery, consulta tipada de varios criterios.
+
+/**
+ * @class SearchQuery
+ * @brief Consulta de búsqueda formada por condiciones sobre campos de Component combinadas
+ * con AND y OR.
+ *
+ * La consulta es solo una descripción: InventoryCache la compila en un plan sobre sus
+ * índices y columnas, y DatabaseManager en una cláusula WHERE parametrizada. En ambos casos
+ * los textos y valores se convierten una sola vez, antes de recorrer filas.
+ *
+ * Se puede construir con where(), allOf() y anyOf(), o a partir de texto con parse():
+ * @code
+ * tipo=resistor AND cantidad<10
+ * (ubicacion^A OR ubicacion^B) AND fecha=2024-01-01..2024-06-30
+ * @endcode
+ */
+class SearchQuery {
+public:
+    /**
+     * @brief Operador de comparación de una condición.
+     */
+    enum class Op {
+        Equals,    ///< Igual (en textos, sin distinguir mayúsculas).
+        Less,      ///< Menor que.
+        Greater,   ///< Mayor que.
+        Between,   ///< Entre dos valores, ambos incluidos; un extremo nulo deja el rango abierto.
+        Contains,  ///< El texto contiene el valor, sin distinguir mayúsculas.
+        Prefix     ///< El texto empieza por el valor, sin distinguir mayúsculas.
+    };
+
+    /**
+     * @brief Tipo de nodo de la consulta.
+     */
+    enum class Kind {
+        Condition, ///< Condición simple sobre un campo.
+        And,       ///< Se cumplen todas las subconsultas.
+        Or         ///< Se cumple alguna subconsulta.
+    };
+
+    /**
+     * @struct Condition
+     * @brief Comparación de un campo con uno o dos valores.
+     *
+     * Los valores son int para Id y Cantidad, QDate para FechaAdquisicion y QString para
+     * los campos de texto.
+     */
+    struct Condition {
+        Component::Field field = Component::Field::Id; ///< Campo comparado.
+        Op op = Op::Equals;                            ///< Operador.
+        QVariant value;                                ///< Valor (límite inferior en Between).
+        QVariant upper;                                ///< Límite superior en Between.
+    };
+
+    /**
+     * @brief Construye una consulta vacía (no válida).
+     */
+    SearchQuery() = default;
+
+    /**
+     * @brief Consulta de una sola condición.
+     * @param field Campo a comparar.
+     * @param op Operador.
+     * @param value Valor, o límite inferior en Between.
+     * @param upper Límite superior en Between.
+     * @return Consulta con la condición.
+     */
+    static SearchQuery where(Component::Field field, Op op,
+                             const QVariant& value, const QVariant& upper = QVariant());
+
+    /**
+     * @brief Consulta que exige todas las subconsultas.
+     * @param parts Subconsultas.
+     * @return Nodo AND.
+     */
+    static SearchQuery allOf(const std::vector<SearchQuery>& parts);
+
+    /**
+     * @brief Consulta que exige alguna de las subconsultas.
+     * @param parts Subconsultas.
+     * @return Nodo OR.
+     */
+    static SearchQuery anyOf(const std::vector<SearchQuery>& parts);
+
+    /**
+     * @brief Interpreta una consulta escrita como texto.
+     *
+     * Cada condición es "campo operador valor", con los campos nombre, tipo, cantidad,
+     * ubicacion (o ubicación), fecha e id, y los operadores = < > ~ (contiene) y ^ (empieza
+     * por). Un valor "a..b" con = es un rango (Between). Los valores con espacios van entre
+     * comillas dobles. Las condiciones se combinan con AND y OR (AND tiene prioridad) y con
+     * paréntesis.
+     *
+     * @param text Texto de la consulta.
+     * @param error Si no es nulo, recibe la descripción del error.
+     * @return Consulta interpretada, o una no válida si el texto tiene errores.
+     */
+    static SearchQuery parse(const QString& text, QString* error = nullptr);
+
+    /**
+     * @brief Consulta equivalente a los criterios simples de la pestaña de búsqueda.
+     *
+     * Nombre, Tipo y Ubicación buscan texto contenido; Cantidad, igualdad; Fecha, una fecha
+     * "aaaa-mm-dd" o un rango "aaaa-mm-dd..aaaa-mm-dd" con extremos opcionales.
+     *
+     * @param keyword Texto introducido.
+     * @param criteria Nombre del criterio.
+     * @return Consulta equivalente, o una no válida si el texto no se puede interpretar.
+     */
+    static SearchQuery fromCriteria(const QString& keyword, const QString& criteria);
+
+    /**
+     * @brief Indica si la consulta tiene al menos una condición bien formada.
+     * @return true si se puede ejecutar.
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Indica si los resultados se ordenan por relevancia (bm25) en lugar de por ID.
+     *
+     * Es el caso de una única condición "nombre contiene" de al menos tres caracteres (el
+     * mínimo del tokenizador trigram), la búsqueda por nombre de la pestaña de búsqueda.
+     *
+     * @return true si la consulta se ordena por relevancia.
+     */
+    bool isRankedByRelevance() const;
+
+    /**
+     * @brief Texto canónico de la consulta, útil como clave de caché.
+     *
+     * Dos consultas con la misma clave devuelven los mismos resultados: los valores de texto
+     * se normalizan con SearchKey (como en la búsqueda) y se escriben entre comillas con
+     * \\ y " escapados, las fechas se escriben como aaaa-mm-dd y los nodos AND y OR se
+     * escriben entre paréntesis en su orden.
+     *
+     * @return Clave, vacía si la consulta no es válida.
+     */
+    QString key() const;
+
+    /**
+     * @brief Tipo de nodo.
+     * @return Condition, And u Or.
+     */
+    Kind kind() const { return m_kind; }
+
+    /**
+     * @brief Condición del nodo (solo si kind() es Condition).
+     * @return Condición.
+     */
+    const Condition& condition() const { return m_condition; }
+
+    /**
+     * @brief Subconsultas del nodo (solo si kind() es And u Or).
+     * @return Subconsultas en el orden en que se escribieron.
+     */
+    const std::vector<SearchQuery>& parts() const { return m_parts; }
+
+    /**
+     * @brief Indica si un operador es aplicable a un campo.
+     * @param field Campo.
+     * @param op Operador.
+     * @return true para comparaciones numéricas o de fecha sobre Id, Cantidad y
+     *         FechaAdquisicion, y para Equals, Contains y Prefix sobre los textos.
+     */
+    static bool supports(Component::Field field, Op op);
+
+private:
+    Kind m_kind = Kind::Condition;   ///< Tipo de nodo.
+    Condition m_condition;           ///< Condición si es un nodo simple.
+    std::vector<SearchQuery> m_parts; ///< Subconsultas si es un nodo AND u OR.
+    bool m_valid = false;            ///< Indica si la consulta está bien formada.
+};
+
+#endif // SEARCHQUERY_H
@@ -4,10 +4,12 @@
  */
 
 #include "searchtab.h"
+#include "fieldcompleter.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QTableWidgetItem>
 #include <QLabel>
+#include <QMessageBox>
 
 /**
  * @brief Constructor de la clase SearchTab.
@@ -25,14 +27,19 @@ SearchTab::SearchTab(InventoryManager* manager, QWidget* parent)
     QHBoxLayout* searchLayout = new QHBoxLayout;
 
     searchCriteriaCombo = new QComboBox(this);
-    searchCriteriaCombo->addItems({"Nombre", "Tipo", "Cantidad", "Ubicación", "Fecha"});
+    searchCriteriaCombo->addItems({"Nombre", "Tipo", "Cantidad", "Ubicación", "Fecha", "Consulta"});
 
     searchEdit = new QLineEdit(this);
+    searchCompleter = new FieldCompleter(m_manager, Component::Field::Nombre, searchEdit);
     searchButton = new QPushButton("Buscar", this);
 
+    fuzzyCheck = new QCheckBox("Aproximada", this);
+    fuzzyCheck->setToolTip("Encuentra nombres parecidos aunque tengan errores de escritura");
+
     searchLayout->addWidget(new QLabel("Buscar por:", this));
     searchLayout->addWidget(searchCriteriaCombo);
     searchLayout->addWidget(searchEdit);
+    searchLayout->addWidget(fuzzyCheck);
     searchLayout->addWidget(searchButton);
     mainLayout->addLayout(searchLayout);
 
@@ -44,19 +51,60 @@ SearchTab::SearchTab(InventoryManager* manager, QWidget* parent)
     mainLayout->addWidget(resultTable);
 
     connect(searchButton, &QPushButton::clicked, this, &SearchTab::performSearch);
+
+    connect(searchEdit, &QLineEdit::returnPressed, this, &SearchTab::performSearch);
+
+    // Indicar el formato esperado cuando se busca por fecha o con una consulta
+    connect(searchCriteriaCombo, &QComboBox::currentTextChanged, this, [this](const QString& criteria) {
+        // La búsqueda aproximada solo se aplica a los nombres
+        fuzzyCheck->setEnabled(criteria == "Nombre");
+
+        // Sugerir valores solo en los criterios de texto
+        searchCompleter->setActive(criteria == "Nombre" || criteria == "Tipo" || criteria == "Ubicación");
+        if (criteria == "Tipo")
+            searchCompleter->setField(Component::Field::Tipo);
+        else if (criteria == "Ubicación")
+            searchCompleter->setField(Component::Field::Ubicacion);
+        else
+            searchCompleter->setField(Component::Field::Nombre);
+
+        if (criteria == "Fecha")
+            searchEdit->setPlaceholderText("aaaa-mm-dd o aaaa-mm-dd..aaaa-mm-dd");
+        else if (criteria == "Consulta")
+            searchEdit->setPlaceholderText("tipo=resistor AND cantidad<10  (operadores: = < > ~ ^)");
+        else
+            searchEdit->setPlaceholderText(QString());
+    });
 }
 
 /**
  * @brief Realiza la búsqueda de componentes según el criterio y palabra clave ingresados.
  *
- * Llama al método searchComponents del InventoryManager y muestra los resultados en una tabla.
+ * Con el criterio "Consulta" el texto se interpreta como una SearchQuery de varias
+ * condiciones; con "Nombre" y la opción "Aproximada" marcada, los resultados son los nombres
+ * más parecidos, ordenados por parecido; con los demás se usa un único criterio. Los
+ * resultados se muestran en la tabla.
  */
 void SearchTab::performSearch()
 {
     QString keyword = searchEdit->text();
     QString criteria = searchCriteriaCombo->currentText();
 
-    QList<Component> results = m_manager->searchComponents(keyword, criteria);
+    QList<Component> results;
+    if (criteria == "Consulta") {
+        QString error;
+        const SearchQuery query = SearchQuery::parse(keyword, &error);
+        if (!query.isValid()) {
+            QMessageBox::warning(this, "Consulta no válida",
+                                 error.isEmpty() ? QString("La consulta está vacía.") : error);
+            return;
+        }
+        results = m_manager->search(query);
+    } else if (criteria == "Nombre" && fuzzyCheck->isChecked()) {
+        results = m_manager->fuzzySearch(keyword);
+    } else {
+        results = m_manager->searchComponents(keyword, criteria);
+    }
     resultTable->setRowCount(results.size());
 
     for (int i = 0; i < results.size(); ++i) {
@@ -11,8 +11,11 @@
 #include <QPushButton>
 #include <QTableWidget>
 #include <QComboBox>
+#include <QCheckBox>
 #include "inventorymanager.h"
 
+class FieldCompleter;
+
 /**
  * @class SearchTab
  * @brief Clase que proporciona una interfaz para buscar componentes dentro del inventario.
@@ -45,6 +48,8 @@ private:
     QPushButton* searchButton;        /**< Botón para iniciar la búsqueda. */
     QTableWidget* resultTable;        /**< Tabla para mostrar los resultados de la búsqueda. */
     QComboBox* searchCriteriaCombo;   /**< ComboBox para seleccionar el criterio de búsqueda. */
+    QCheckBox* fuzzyCheck;            /**< Activa la búsqueda aproximada por nombre (tolera errores). */
+    FieldCompleter* searchCompleter;  /**< Sugerencias del campo de búsqueda según el criterio. */
 };
 
 #endif // SEARCHTAB_H
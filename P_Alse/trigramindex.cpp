@@ -0,0 +1,461 @@
+/// @file trigramindex.cpp
+/// @brief Implementación de la clase TrigramIndex.
+
+#include "trigramindex.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+/// Anotaciones (lápidas + pendientes) que se toleran siempre antes de compactar una lista.
+constexpr int kMinOverlay = 16;
+/// Además, se compacta cuando las anotaciones superan 1/kOverlayFraction de la lista.
+constexpr int kOverlayFraction = 8;
+}
+
+/**
+ * @brief Elimina todas las listas.
+ */
+void TrigramIndex::clear()
+{
+    m_postings.clear();
+}
+
+/**
+ * @brief Agrega el ID a la lista de cada trigrama del texto.
+ * @param id ID del elemento.
+ * @param text Texto a indexar.
+ */
+void TrigramIndex::insert(int id, const QString& text)
+{
+    for (quint64 key : trigrams(text))
+        insertId(key, id);
+}
+
+/**
+ * @brief Quita el ID de la lista de cada trigrama del texto.
+ * @param id ID del elemento.
+ * @param text Texto con el que se indexó.
+ */
+void TrigramIndex::remove(int id, const QString& text)
+{
+    for (quint64 key : trigrams(text))
+        removeId(key, id);
+}
+
+/**
+ * @brief Recorre a la vez los trigramas (ordenados) de ambos textos y solo modifica las
+ * listas de los que aparecen en uno de ellos.
+ * @param id ID del elemento.
+ * @param oldText Texto anterior.
+ * @param newText Texto nuevo.
+ */
+void TrigramIndex::replace(int id, const QString& oldText, const QString& newText)
+{
+    const QVector<quint64> oldKeys = trigrams(oldText);
+    const QVector<quint64> newKeys = trigrams(newText);
+
+    int i = 0;
+    int j = 0;
+    while (i < oldKeys.size() || j < newKeys.size()) {
+        if (j == newKeys.size() || (i < oldKeys.size() && oldKeys.at(i) < newKeys.at(j))) {
+            removeId(oldKeys.at(i++), id);
+        } else if (i == oldKeys.size() || newKeys.at(j) < oldKeys.at(i)) {
+            insertId(newKeys.at(j++), id);
+        } else {
+            ++i;
+            ++j;
+        }
+    }
+}
+
+/**
+ * @brief Agrega un ID a una lista.
+ *
+ * Los IDs nuevos suelen ser mayores que todos los existentes, y entonces basta con añadir
+ * una diferencia al final. Un ID con lápida la pierde; cualquier otro ID menor va a los
+ * pendientes.
+ *
+ * @param key Trigrama.
+ * @param id ID.
+ */
+void TrigramIndex::insertId(quint64 key, int id)
+{
+    Posting& posting = m_postings[key];
+    if (posting.bytes.isEmpty() || id > posting.last) {
+        appendVarint(posting.bytes, quint32(id - posting.last));
+        posting.last = id;
+        ++posting.count;
+        return;
+    }
+
+    auto removed = std::lower_bound(posting.removed.begin(), posting.removed.end(), id);
+    if (removed != posting.removed.end() && *removed == id) {
+        posting.removed.erase(removed);
+        ++posting.count;
+        return;
+    }
+
+    auto pending = std::lower_bound(posting.pending.begin(), posting.pending.end(), id);
+    if (pending != posting.pending.end() && *pending == id)
+        return;
+    posting.pending.insert(pending, id);
+    ++posting.count;
+    compactIfNeeded(posting);
+}
+
+/**
+ * @brief Quita un ID de una lista: de los pendientes si está ahí y, si no, con una lápida.
+ * @param key Trigrama.
+ * @param id ID, que debe estar en la lista.
+ */
+void TrigramIndex::removeId(quint64 key, int id)
+{
+    auto found = m_postings.find(key);
+    if (found == m_postings.end())
+        return;
+    Posting& posting = found.value();
+
+    auto pending = std::lower_bound(posting.pending.begin(), posting.pending.end(), id);
+    if (pending != posting.pending.end() && *pending == id) {
+        posting.pending.erase(pending);
+    } else {
+        auto removed = std::lower_bound(posting.removed.begin(), posting.removed.end(), id);
+        if (removed != posting.removed.end() && *removed == id)
+            return;
+        posting.removed.insert(removed, id);
+    }
+
+    if (--posting.count == 0)
+        m_postings.erase(found);
+    else
+        compactIfNeeded(posting);
+}
+
+/**
+ * @brief Recodifica una lista cuando sus anotaciones pasan de max(kMinOverlay,
+ * count / kOverlayFraction).
+ *
+ * Así cada compactación, que cuesta O(count), se reparte entre al menos count /
+ * kOverlayFraction modificaciones.
+ *
+ * @param posting Lista.
+ */
+void TrigramIndex::compactIfNeeded(Posting& posting)
+{
+    const int overlay = posting.removed.size() + posting.pending.size();
+    if (overlay <= std::max(kMinOverlay, posting.count / kOverlayFraction))
+        return;
+    posting = encode(decode(posting));
+}
+
+/**
+ * @brief Interseca las listas de los trigramas de la palabra, de la más corta a la más larga.
+ * @param keyword Subcadena buscada.
+ * @return IDs candidatos, o std::nullopt si la palabra es demasiado corta.
+ */
+std::optional<QVector<int>> TrigramIndex::candidates(const QString& keyword) const
+{
+    const QVector<quint64> keys = trigrams(keyword);
+    if (keys.isEmpty())
+        return std::nullopt;
+
+    QVector<const Posting*> lists;
+    lists.reserve(keys.size());
+    for (quint64 key : keys) {
+        auto it = m_postings.constFind(key);
+        if (it == m_postings.constEnd())
+            return QVector<int>();
+        lists.append(&it.value());
+    }
+
+    std::sort(lists.begin(), lists.end(), [](const Posting* a, const Posting* b) {
+        return a->count < b->count;
+    });
+
+    QVector<int> ids = decode(*lists.first());
+    for (int i = 1; i < lists.size() && !ids.isEmpty(); ++i)
+        intersect(ids, *lists.at(i));
+    return ids;
+}
+
+/**
+ * @brief Longitud de la lista más corta entre los trigramas de la palabra.
+ * @param keyword Subcadena buscada.
+ * @return Número máximo de candidatos, o -1 si la palabra es demasiado corta.
+ */
+int TrigramIndex::estimate(const QString& keyword) const
+{
+    const QVector<quint64> keys = trigrams(keyword);
+    if (keys.isEmpty())
+        return -1;
+
+    int shortest = std::numeric_limits<int>::max();
+    for (quint64 key : keys) {
+        auto it = m_postings.constFind(key);
+        if (it == m_postings.constEnd())
+            return 0;
+        shortest = std::min(shortest, it.value().count);
+    }
+    return shortest;
+}
+
+/**
+ * @brief Cuenta cuántos trigramas del patrón contiene cada ID.
+ *
+ * Si hay D trigramas y se exigen t, todo ID válido aparece en alguna de las D - t + 1
+ * listas más cortas: solo esas se decodifican y se mezclan para obtener los candidatos.
+ * Las t - 1 listas largas se recorren después sin decodificarlas por completo, sumando
+ * coincidencias únicamente sobre esos candidatos.
+ *
+ * @param keyword Patrón buscado.
+ * @param minShared Trigramas comunes exigidos.
+ * @return IDs ordenados, o std::nullopt si no se puede filtrar.
+ */
+std::optional<QVector<int>> TrigramIndex::candidatesSharing(const QString& keyword, int minShared) const
+{
+    const QVector<quint64> keys = trigrams(keyword);
+    if (minShared <= 0 || keys.isEmpty())
+        return std::nullopt;
+    if (minShared > keys.size())
+        return QVector<int>();
+
+    static const Posting empty;
+    QVector<const Posting*> lists;
+    lists.reserve(keys.size());
+    for (quint64 key : keys) {
+        auto it = m_postings.constFind(key);
+        lists.append(it == m_postings.constEnd() ? &empty : &it.value());
+    }
+    std::sort(lists.begin(), lists.end(), [](const Posting* a, const Posting* b) {
+        return a->count < b->count;
+    });
+
+    const int shortLists = lists.size() - minShared + 1;
+    QVector<int> all;
+    for (int i = 0; i < shortLists; ++i)
+        all += decode(*lists.at(i));
+    std::sort(all.begin(), all.end());
+
+    QVector<int> ids;
+    QVector<int> counts;
+    for (int i = 0; i < all.size();) {
+        int end = i + 1;
+        while (end < all.size() && all.at(end) == all.at(i))
+            ++end;
+        ids.append(all.at(i));
+        counts.append(end - i);
+        i = end;
+    }
+
+    for (int i = shortLists; i < lists.size() && !ids.isEmpty(); ++i) {
+        countMatches(ids, counts, *lists.at(i));
+
+        // Se descartan los que ya no pueden llegar aunque aparezcan en todas las listas restantes.
+        const int remaining = lists.size() - i - 1;
+        int kept = 0;
+        for (int j = 0; j < ids.size(); ++j) {
+            if (counts.at(j) + remaining >= minShared) {
+                ids[kept] = ids.at(j);
+                counts[kept] = counts.at(j);
+                ++kept;
+            }
+        }
+        ids.resize(kept);
+        counts.resize(kept);
+    }
+
+    int kept = 0;
+    for (int j = 0; j < ids.size(); ++j) {
+        if (counts.at(j) >= minShared)
+            ids[kept++] = ids.at(j);
+    }
+    ids.resize(kept);
+    return ids;
+}
+
+/**
+ * @brief Número de trigramas distintos de un texto.
+ * @param text Texto.
+ * @return Trigramas distintos.
+ */
+int TrigramIndex::trigramCount(const QString& text)
+{
+    return trigrams(text).size();
+}
+
+/**
+ * @brief Calcula las claves de los trigramas de un texto.
+ *
+ * Cada trigrama son tres unidades UTF-16 del texto en minúsculas empaquetadas en 48 bits.
+ *
+ * @param text Texto original.
+ * @return Claves ordenadas y sin repetir.
+ */
+QVector<quint64> TrigramIndex::trigrams(const QString& text)
+{
+    const QString folded = text.toCaseFolded();
+    QVector<quint64> keys;
+    if (folded.size() < 3)
+        return keys;
+
+    keys.reserve(folded.size() - 2);
+    for (int i = 0; i + 2 < folded.size(); ++i) {
+        keys.append((quint64(folded.at(i).unicode()) << 32)
+                    | (quint64(folded.at(i + 1).unicode()) << 16)
+                    | quint64(folded.at(i + 2).unicode()));
+    }
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+/**
+ * @brief Decodifica una lista con un Cursor.
+ * @param posting Lista comprimida.
+ * @return IDs vigentes en orden creciente.
+ */
+QVector<int> TrigramIndex::decode(const Posting& posting)
+{
+    QVector<int> ids;
+    ids.reserve(posting.count);
+
+    Cursor cursor(posting);
+    int id;
+    while (cursor.next(id))
+        ids.append(id);
+    return ids;
+}
+
+/**
+ * @brief Codifica una lista ordenada de IDs.
+ * @param ids IDs en orden creciente.
+ * @return Lista comprimida.
+ */
+TrigramIndex::Posting TrigramIndex::encode(const QVector<int>& ids)
+{
+    Posting posting;
+    for (int id : ids) {
+        appendVarint(posting.bytes, quint32(id - posting.last));
+        posting.last = id;
+    }
+    posting.count = ids.size();
+    return posting;
+}
+
+/**
+ * @brief Intersección por mezcla de una lista decodificada con una comprimida.
+ * @param ids IDs ordenados; al terminar solo quedan los comunes.
+ * @param posting Lista comprimida.
+ */
+void TrigramIndex::intersect(QVector<int>& ids, const Posting& posting)
+{
+    Cursor cursor(posting);
+    int kept = 0;
+    int next = 0;
+    int id;
+    while (next < ids.size() && cursor.next(id)) {
+
+        while (next < ids.size() && ids.at(next) < id)
+            ++next;
+        if (next < ids.size() && ids.at(next) == id)
+            ids[kept++] = ids.at(next++);
+    }
+    ids.resize(kept);
+}
+
+/**
+ * @brief Recorre a la vez los candidatos y la lista comprimida, contando coincidencias.
+ * @param ids IDs ordenados.
+ * @param counts Contadores paralelos a @p ids.
+ * @param posting Lista comprimida.
+ */
+void TrigramIndex::countMatches(const QVector<int>& ids, QVector<int>& counts, const Posting& posting)
+{
+    Cursor cursor(posting);
+    int next = 0;
+    int id;
+    while (next < ids.size() && cursor.next(id)) {
+
+        while (next < ids.size() && ids.at(next) < id)
+            ++next;
+        if (next < ids.size() && ids.at(next) == id)
+            ++counts[next++];
+    }
+}
+
+/**
+ * @brief Prepara el recorrido de los datos codificados, las lápidas y los pendientes.
+ * @param posting Lista.
+ */
+TrigramIndex::Cursor::Cursor(const Posting& posting)
+    : m_posting(posting),
+      m_data(reinterpret_cast<const uchar*>(posting.bytes.constData())),
+      m_end(m_data + posting.bytes.size())
+{
+}
+
+/**
+ * @brief Entrega el menor entre el siguiente ID codificado sin lápida y el siguiente pendiente.
+ *
+ * Las lápidas están ordenadas igual que los datos codificados, así que se avanza por ellas
+ * a la par y cada una se consulta una sola vez.
+ *
+ * @param id Recibe el ID.
+ * @return false al terminar.
+ */
+bool TrigramIndex::Cursor::next(int& id)
+{
+    const QVector<int>& removed = m_posting.removed;
+    while (!m_hasCoded && m_data < m_end) {
+        m_coded += int(readVarint(m_data, m_end));
+        while (m_removed < removed.size() && removed.at(m_removed) < m_coded)
+            ++m_removed;
+        m_hasCoded = m_removed == removed.size() || removed.at(m_removed) != m_coded;
+    }
+
+    const QVector<int>& pending = m_posting.pending;
+    if (m_pending < pending.size() && (!m_hasCoded || pending.at(m_pending) < m_coded)) {
+        id = pending.at(m_pending++);
+        return true;
+    }
+    if (m_hasCoded) {
+        id = m_coded;
+        m_hasCoded = false;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Lee un varint: 7 bits por byte, el bit alto indica que sigue otro.
+ * @param data Posición de lectura.
+ * @param end Final de los datos.
+ * @return Valor leído.
+ */
+quint32 TrigramIndex::readVarint(const uchar*& data, const uchar* end)
+{
+    quint32 value = 0;
+    int shift = 0;
+    uchar byte;
+    do {
+        byte = *data++;
+        value |= quint32(byte & 0x7F) << shift;
+        shift += 7;
+    } while ((byte & 0x80) && data < end);
+    return value;
+}
+
+/**
+ * @brief Escribe un entero sin signo en varint: 7 bits por byte, el bit alto indica que sigue otro.
+ * @param bytes Destino.
+ * @param delta Valor a escribir.
+ */
+void TrigramIndex::appendVarint(QByteArray& bytes, quint32 delta)
+{
+    while (delta >= 0x80) {
+        bytes.append(char((delta & 0x7F) | 0x80));
+        delta >>= 7;
+    }
+    bytes.append(char(delta));
+}
@@ -0,0 +1,220 @@
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <optional>
+
+/// @file trigramindex.h
+/// @brief Declaración de la clase TrigramIndex, índice de subcadenas por trigramas.
+
+/**
+ * @class TrigramIndex
+ * @brief Índice invertido de trigramas para buscar subcadenas sin distinguir mayúsculas.
+ *
+ * Cada texto se pasa a minúsculas (case folding) y se descompone en sus secuencias de tres
+ * caracteres. Para cada trigrama se guarda la lista ordenada de IDs que lo contienen,
+ * comprimida como diferencias entre IDs consecutivos codificadas en varint (1 byte para
+ * diferencias menores de 128).
+ *
+ * Añadir un ID mayor que el último de la lista es escribir una diferencia al final. Las
+ * demás modificaciones no recodifican la lista: las bajas se anotan como lápidas y las
+ * altas por debajo del último ID en una lista pendiente sin comprimir. Las lecturas mezclan
+ * ambas con la lista comprimida al recorrerla, y la lista se recodifica (compactación)
+ * solo cuando las anotaciones superan una fracción de su tamaño.
+ *
+ * Una subcadena de al menos tres caracteres solo puede aparecer en los textos que contienen
+ * todos sus trigramas, así que candidates() interseca esas listas empezando por la más corta.
+ * El resultado es un superconjunto: quien llama debe verificar cada candidato.
+ */
+class TrigramIndex {
+public:
+    /**
+     * @brief Vacía el índice.
+     */
+    void clear();
+
+    /**
+     * @brief Indexa un texto bajo un ID.
+     * @param id ID del elemento.
+     * @param text Texto a indexar.
+     */
+    void insert(int id, const QString& text);
+
+    /**
+     * @brief Quita del índice un texto indexado antes con insert().
+     * @param id ID del elemento.
+     * @param text El mismo texto que se indexó.
+     */
+    void remove(int id, const QString& text);
+
+    /**
+     * @brief Cambia el texto indexado bajo un ID, tocando solo los trigramas que difieren.
+     * @param id ID del elemento.
+     * @param oldText Texto con el que se indexó.
+     * @param newText Texto nuevo.
+     */
+    void replace(int id, const QString& oldText, const QString& newText);
+
+    /**
+     * @brief IDs cuyo texto puede contener @p keyword.
+     * @param keyword Subcadena buscada.
+     * @return IDs ordenados que contienen todos los trigramas de @p keyword, o std::nullopt
+     *         si la palabra tiene menos de tres caracteres y el índice no puede filtrar.
+     */
+    std::optional<QVector<int>> candidates(const QString& keyword) const;
+
+    /**
+     * @brief Cota superior del número de candidatos, sin decodificar ninguna lista.
+     * @param keyword Subcadena buscada.
+     * @return Longitud de la lista más corta de sus trigramas, o -1 si la palabra tiene
+     *         menos de tres caracteres.
+     */
+    int estimate(const QString& keyword) const;
+
+    /**
+     * @brief IDs cuyo texto comparte al menos @p minShared trigramas distintos con @p keyword.
+     *
+     * Es el filtro de la búsqueda aproximada: cada error de edición destruye como mucho tres
+     * trigramas, así que una aparición con k errores conserva al menos
+     * trigramCount(keyword) - 3k de ellos.
+     *
+     * @param keyword Patrón buscado.
+     * @param minShared Trigramas comunes exigidos.
+     * @return IDs ordenados, o std::nullopt si @p minShared no es positivo y el índice no
+     *         puede descartar nada.
+     */
+    std::optional<QVector<int>> candidatesSharing(const QString& keyword, int minShared) const;
+
+    /**
+     * @brief Número de trigramas distintos de un texto, sin distinguir mayúsculas.
+     * @param text Texto.
+     * @return Trigramas distintos (0 si tiene menos de tres caracteres).
+     */
+    static int trigramCount(const QString& text);
+
+private:
+    /**
+     * @struct Posting
+     * @brief Lista de IDs de un trigrama, comprimida con diferencias varint.
+     */
+    struct Posting {
+        QByteArray bytes;      ///< Diferencias codificadas.
+        int last = 0;          ///< Último ID codificado (para añadir al final sin decodificar).
+        int count = 0;         ///< Número de IDs vigentes (codificados - lápidas + pendientes).
+        QVector<int> removed;  ///< Lápidas: IDs codificados que ya no están, ordenados.
+        QVector<int> pending;  ///< IDs menores que @c last aún sin codificar, ordenados.
+    };
+
+    /**
+     * @class Cursor
+     * @brief Recorre los IDs vigentes de una lista en orden creciente.
+     *
+     * Decodifica las diferencias sobre la marcha, salta las lápidas y mezcla los pendientes.
+     */
+    class Cursor {
+    public:
+        /**
+         * @brief Se coloca antes del primer ID.
+         * @param posting Lista a recorrer; debe seguir viva mientras se use el cursor.
+         */
+        explicit Cursor(const Posting& posting);
+
+        /**
+         * @brief Avanza al siguiente ID vigente.
+         * @param id Recibe el ID.
+         * @return false si no quedan IDs.
+         */
+        bool next(int& id);
+
+    private:
+        const Posting& m_posting; ///< Lista recorrida.
+        const uchar* m_data;      ///< Siguiente byte codificado.
+        const uchar* m_end;       ///< Final de los datos codificados.
+        int m_coded = 0;          ///< Último ID codificado leído.
+        bool m_hasCoded = false;  ///< Indica si @c m_coded aún no se entregó.
+        int m_removed = 0;        ///< Posición en las lápidas.
+        int m_pending = 0;        ///< Posición en los pendientes.
+    };
+
+    /**
+     * @brief Agrega un ID a la lista de un trigrama.
+     * @param key Trigrama.
+     * @param id ID.
+     */
+    void insertId(quint64 key, int id);
+
+    /**
+     * @brief Quita un ID de la lista de un trigrama.
+     * @param key Trigrama.
+     * @param id ID.
+     */
+    void removeId(quint64 key, int id);
+
+    /**
+     * @brief Recodifica la lista si sus lápidas y pendientes superan el umbral.
+     * @param posting Lista.
+     */
+    static void compactIfNeeded(Posting& posting);
+
+    /**
+     * @brief Trigramas distintos de un texto, ya pasado a minúsculas.
+     * @param text Texto original.
+     * @return Claves de trigrama sin repetir.
+     */
+    static QVector<quint64> trigrams(const QString& text);
+
+    /**
+     * @brief Decodifica una lista completa, aplicando lápidas y pendientes.
+     * @param posting Lista comprimida.
+     * @return IDs vigentes en orden creciente.
+     */
+    static QVector<int> decode(const Posting& posting);
+
+    /**
+     * @brief Codifica una lista de IDs ordenados.
+     * @param ids IDs en orden creciente.
+     * @return Lista comprimida.
+     */
+    static Posting encode(const QVector<int>& ids);
+
+    /**
+     * @brief Conserva en @p ids solo los que también aparecen en @p posting.
+     *
+     * La lista comprimida se decodifica sobre la marcha (con un Cursor) mientras se
+     * recorren ambas.
+     *
+     * @param ids IDs ordenados; se reduce en el sitio.
+     * @param posting Lista con la que se interseca.
+     */
+    static void intersect(QVector<int>& ids, const Posting& posting);
+
+    /**
+     * @brief Suma 1 en @p counts a cada ID de @p ids que aparece en @p posting.
+     * @param ids IDs ordenados.
+     * @param counts Contador por posición de @p ids.
+     * @param posting Lista comprimida.
+     */
+    static void countMatches(const QVector<int>& ids, QVector<int>& counts, const Posting& posting);
+
+    /**
+     * @brief Lee una diferencia en formato varint.
+     * @param data Posición de lectura; avanza tras el valor.
+     * @param end Final de los datos.
+     * @return Valor leído.
+     */
+    static quint32 readVarint(const uchar*& data, const uchar* end);
+
+    /**
+     * @brief Añade una diferencia en formato varint.
+     * @param bytes Destino.
+     * @param delta Diferencia positiva.
+     */
+    static void appendVarint(QByteArray& bytes, quint32 delta);
+
+    QHash<quint64, Posting> m_postings; ///< Trigrama -> lista de IDs.
+};
+
+#endif // TRIGRAMINDEX_H